@@ -0,0 +1,1003 @@
+/* File: btreemapshpp.h
+ * --------------------------------------------------
+ * This interface exports a version of map based on
+ * B+ tree. It has the same interface as MapSHPP, but
+ * keeps many keys in every node, so a lookup touches
+ * a few nodes instead of one node per tree level.
+ */
+#ifndef BTREEMAPSHPP_H
+#define BTREEMAPSHPP_H
+
+#include <iostream>
+#include <stdlib.h>
+#include <utility>
+#include "serializeshpp.h"
+
+
+/* Class: BTreeMapSHPP
+ * -------------------------------------------------
+ * This class implements map of a specified ValueType
+ * elements. Inner nodes keep only separator keys and links,
+ * all elements are stored in the leaves and leaves are linked
+ * in key order. Keys and values need default constructors.
+ */
+template<typename KeyType, typename ValueType>
+class BTreeMapSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: BTreeMapSHPP
+     * Usage: BTreeMapSHPP<KeyType, ValueType> map;
+     * -----------------------------------------------------
+     * Initializes a new empty map
+     */
+    BTreeMapSHPP();
+
+    /* Destructor: ~BTreeMapSHPP
+    * ----------------------------------------------
+    * Frees all allocated memory for the map elements
+    */
+    virtual ~BTreeMapSHPP();
+
+    /* Copy constructor*/
+    BTreeMapSHPP(const BTreeMapSHPP<KeyType, ValueType>& src);
+
+    /* Operator: =
+     * mapNew = mapOld;
+     * -----------------------------------------------------
+     * Overloads assign operator
+     */
+    BTreeMapSHPP<KeyType, ValueType>& operator=(const BTreeMapSHPP<KeyType, ValueType>& src);
+
+    /* Method: put
+     * Usage: map.put(key, value);
+     * -----------------------------------------------
+     * Put the value in accordance with the key.
+     * If this key already exists then its value is replaced by a new
+     */
+    void put(const KeyType& key, const ValueType& value);
+    void put(const KeyType& key, ValueType&& value);
+    void put(KeyType&& key, ValueType&& value);
+
+    /* Method: emplace
+     * Usage: if (map.emplace(key, args...))...
+     * -----------------------------------------------
+     * Inserts the value constructed from the received arguments
+     * if the key is absent. Returns true if the element was
+     * inserted, existing values stay unchanged
+     */
+    template<typename... Args>
+    bool emplace(const KeyType& key, Args&&... args);
+    template<typename... Args>
+    bool emplace(KeyType&& key, Args&&... args);
+
+    /* Method: get
+     * Usage: value = map.get(key);
+     * -----------------------------------------------
+     * Returns the value of the corresponding key
+     */
+    ValueType get(const KeyType& key);
+
+    /* Method: isEmpty
+     * Usage: if (map.isEmpty());
+     * -----------------------------------------------
+     * Returns true if map is empty
+     */
+    bool isEmpty();
+
+    /* Method: clear
+     * Usage: map.clear();
+     * ---------------------------------------------
+     * Removes all elements of the map
+     */
+    void clear();
+
+    /* Method: size
+     * Usage: int size = map.size();
+     * --------------------------------------------
+     * Return current number of the elements of the
+     * map
+     */
+    int size();
+
+    /* Method: remove
+     * Usage: map.remove(key);
+     * -----------------------------------------------------
+     * Removes value of the map corresponding to the key
+     */
+    void remove(const KeyType& key);
+
+    /* Method: containsKey
+     * Usage: if (map.containsKey(key))
+     * -----------------------------------------------------
+     * Return true if map contains input key
+     */
+    bool containsKey(const KeyType& key);
+
+    /* Operator: []
+     * Usage: map[key] = value;
+     * ---------------------------------------------------
+     * Returns link to value by the specfied key. If the key
+     * is absent inserts it with default value first
+     */
+    ValueType& operator[](const KeyType& key);
+
+    /* Method: save
+     * Usage: map.save(out);
+     * ---------------------------------------------------
+     * Writes all pairs of key and value to the binary stream
+     * in ascending order of the keys. The format is the same
+     * as of MapSHPP, so either map can load it
+     */
+    void save(std::ostream& out) const;
+
+    /* Method: load
+     * Usage: map.load(in);
+     * ---------------------------------------------------
+     * Replaces the content of the map by the pairs read from
+     * the binary stream written by save
+     */
+    void load(std::istream& in);
+
+    class iterator;
+
+    /* Method: begin
+     * Usage: for (BTreeMapSHPP<KeyType, ValueType>::iterator it = map.begin(); it != map.end(); ++it)
+     * -----------------------------------------------------
+     * Returns iterator to the element with the smallest key
+     */
+    iterator begin();
+
+    /* Method: end
+     * Usage: it != map.end()
+     * -----------------------------------------------------
+     * Returns iterator that points past the element with
+     * the largest key
+     */
+    iterator end();
+
+    /* Method: lowerBound
+     * Usage: iterator it = map.lowerBound(key);
+     * -----------------------------------------------------
+     * Returns iterator to the first element whose key is not
+     * less than the received key
+     */
+    iterator lowerBound(const KeyType& key);
+
+    /* Method: upperBound
+     * Usage: iterator it = map.upperBound(key);
+     * -----------------------------------------------------
+     * Returns iterator to the first element whose key is
+     * greater than the received key
+     */
+    iterator upperBound(const KeyType& key);
+
+    class Range;
+
+    /* Method: range
+     * Usage: for (auto key : map.range(lo, hi))...
+     * -----------------------------------------------------
+     * Returns the elements whose keys lie in [lo, hi) in
+     * ascending order
+     */
+    Range range(const KeyType& lo, const KeyType& hi);
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Size of the node key array in bytes, a few cache lines*/
+    static const int NODE_BYTES = 256;
+
+    /* Maximal number of the keys in one node*/
+    static const int MAX_KEYS = NODE_BYTES / (int)sizeof(KeyType) > 64 ? 64 :
+                                NODE_BYTES / (int)sizeof(KeyType) < 8 ? 8 :
+                                NODE_BYTES / (int)sizeof(KeyType);
+
+    /* Minimal number of the keys in every node except root*/
+    static const int MIN_KEYS = MAX_KEYS / 2;
+
+    /* Upper limit of the tree height*/
+    static const int MAX_HEIGHT = 32;
+
+    /* Common part of the inner nodes and leaves*/
+    struct Node {
+        int count;
+        bool leaf;
+        KeyType keys[MAX_KEYS];
+    };
+
+    /* Leaf keeps elements and link to the next leaf*/
+    struct LeafNode : Node {
+        ValueType values[MAX_KEYS];
+        LeafNode* next;
+    };
+
+    /* Inner node keeps count + 1 links, keys of children[i]
+     * lie in [keys[i - 1], keys[i])*/
+    struct InnerNode : Node {
+        Node* children[MAX_KEYS + 1];
+    };
+
+public:
+
+    /* Class: iterator
+     * -------------------------------------------------
+     * In-order iterator over the map, walks along the
+     * linked leaves. Iterators are invalidated by put
+     * and remove.
+     */
+    class iterator {
+    public:
+
+        /* Constructor: iterator
+         * Usage: BTreeMapSHPP<KeyType, ValueType>::iterator it;
+         * -----------------------------------------------
+         * Initializes an iterator equal to end()
+         */
+        iterator();
+
+        /* Method: key
+         * Usage: KeyType key = it.key();
+         * -----------------------------------------------
+         * Returns the key of the current element
+         */
+        const KeyType& key() const;
+
+        /* Method: value
+         * Usage: it.value() = newValue;
+         * -----------------------------------------------
+         * Returns link to the value of the current element
+         */
+        ValueType& value() const;
+
+        /* Operator: *
+         * Usage: KeyType key = *it;
+         * -----------------------------------------------
+         * Returns the key of the current element
+         */
+        const KeyType& operator*() const;
+
+        /* Operator: ++
+         * Usage: ++it;
+         * -----------------------------------------------
+         * Moves iterator to the element with the next key
+         */
+        iterator& operator++();
+
+        /* Operator: ++
+         * Usage: it++;
+         * -----------------------------------------------
+         * Moves iterator to the element with the next key and
+         * returns its previous state
+         */
+        iterator operator++(int);
+
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+
+    private:
+        friend class BTreeMapSHPP;
+
+        iterator(LeafNode* leaf, int index);
+
+        /* Current leaf or 0 for end()*/
+        LeafNode* leaf;
+
+        /* Index of the current element in the leaf*/
+        int index;
+    };
+
+    /* Class: Range
+     * -------------------------------------------------
+     * Pair of iterators returned by range(), usable in
+     * range-based for loops
+     */
+    class Range {
+    public:
+        Range(const iterator& first, const iterator& last);
+        iterator begin() const;
+        iterator end() const;
+
+    private:
+        iterator first;
+        iterator last;
+    };
+
+private:
+
+    /* Method: lowerIndex
+     * -----------------------------------------------
+     * Returns index of the first key in the node that is
+     * not less than received key
+     */
+    int lowerIndex(Node* node, const KeyType& key);
+
+    /* Method: upperIndex
+     * -----------------------------------------------
+     * Returns index of the first key in the node that is
+     * greater than received key
+     */
+    int upperIndex(Node* node, const KeyType& key);
+
+    /* Method: findLeaf
+     * -----------------------------------------------
+     * Descends to the leaf that may contain the key and
+     * records visited inner nodes and link indexes in path
+     */
+    LeafNode* findLeaf(const KeyType& key, InnerNode* path[], int pathIndex[], int& depth);
+
+    /* Method: insertEntry
+     * -----------------------------------------------
+     * Finds the element with received key. If it is absent
+     * inserts new one with value made from args, splitting
+     * full nodes on the way back to the root. Sets inserted
+     * to true only when the new element was created
+     */
+    template<typename K, typename... Args>
+    ValueType* insertEntry(K&& key, bool& inserted, Args&&... args);
+
+    /* Method: insertIntoParents
+     * -----------------------------------------------
+     * Adds separator and new right node to the parents
+     * recorded in path, splitting them when they are full
+     */
+    void insertIntoParents(InnerNode* path[], int pathIndex[], int depth, KeyType separator, Node* right);
+
+    /* Method: fixUnderflow
+     * -----------------------------------------------
+     * Restores minimal fill of the nodes on the path after
+     * removing by borrowing from a sibling or merging with it
+     */
+    void fixUnderflow(InnerNode* path[], int pathIndex[], int depth, Node* node);
+
+    /* Method: deleteNode
+     * -----------------------------------------------
+     * Frees the node of the right type
+     */
+    void deleteNode(Node* node);
+
+    /* Method: clearTree
+     * -----------------------------------------------
+     * Frees all nodes of the received sub-tree
+     */
+    void clearTree(Node* node);
+
+    /* Method: copyTree
+     * Usage: root = copyTree(src.root, lastLeaf);
+     * -----------------------------------------------
+     * Returns a copy of the received sub-tree. Copied leaves
+     * are linked after lastLeaf in key order
+     */
+    Node* copyTree(const Node* node, LeafNode*& lastLeaf);
+
+    /* Current number of the elements in map*/
+    int count;
+
+    /* Contains link the root node*/
+    Node* root;
+};
+
+
+template<typename KeyType, typename ValueType>
+BTreeMapSHPP<KeyType, ValueType>::BTreeMapSHPP(){
+    root = 0;
+    count = 0;
+}
+
+template<typename KeyType, typename ValueType>
+BTreeMapSHPP<KeyType, ValueType>::~BTreeMapSHPP(){
+    clearTree(root);
+}
+
+template<typename KeyType, typename ValueType>
+BTreeMapSHPP<KeyType, ValueType>::BTreeMapSHPP(const BTreeMapSHPP<KeyType, ValueType>& src){
+    LeafNode* lastLeaf = 0;
+    root = copyTree(src.root, lastLeaf);
+    count = src.count;
+}
+
+template<typename KeyType, typename ValueType>
+BTreeMapSHPP<KeyType, ValueType>& BTreeMapSHPP<KeyType, ValueType>::operator =(const BTreeMapSHPP<KeyType, ValueType>& src){
+    if (this != &src){
+        clear();
+        LeafNode* lastLeaf = 0;
+        root = copyTree(src.root, lastLeaf);
+        count = src.count;
+    }
+    return *this;
+}
+
+template<typename KeyType, typename ValueType>
+int BTreeMapSHPP<KeyType, ValueType>::lowerIndex(Node* node, const KeyType& key){
+    int low = 0;
+    int high = node->count;
+    while (low < high){
+        int middle = (low + high) / 2;
+        if (node->keys[middle] < key){
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+template<typename KeyType, typename ValueType>
+int BTreeMapSHPP<KeyType, ValueType>::upperIndex(Node* node, const KeyType& key){
+    int low = 0;
+    int high = node->count;
+    while (low < high){
+        int middle = (low + high) / 2;
+        if (key < node->keys[middle]){
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::LeafNode* BTreeMapSHPP<KeyType, ValueType>::findLeaf(const KeyType& key, InnerNode* path[], int pathIndex[], int& depth){
+    depth = 0;
+    Node* node = root;
+    while (!node->leaf){
+        InnerNode* inner = static_cast<InnerNode*>(node);
+        int index = upperIndex(inner, key);
+        path[depth] = inner;
+        pathIndex[depth] = index;
+        depth++;
+        node = inner->children[index];
+    }
+    return static_cast<LeafNode*>(node);
+}
+
+template<typename KeyType, typename ValueType>
+template<typename K, typename... Args>
+ValueType* BTreeMapSHPP<KeyType, ValueType>::insertEntry(K&& key, bool& inserted, Args&&... args){
+    if (root == 0){
+        LeafNode* leaf = new LeafNode;
+        leaf->count = 0;
+        leaf->leaf = true;
+        leaf->next = 0;
+        root = leaf;
+    }
+
+    InnerNode* path[MAX_HEIGHT];
+    int pathIndex[MAX_HEIGHT];
+    int depth;
+    LeafNode* leaf = findLeaf(key, path, pathIndex, depth);
+    int position = lowerIndex(leaf, key);
+    if (position < leaf->count && !(key < leaf->keys[position])){
+        inserted = false;
+        return &leaf->values[position];
+    }
+
+    if (leaf->count == MAX_KEYS){
+        LeafNode* right = new LeafNode;
+        right->leaf = true;
+        right->count = MAX_KEYS - MIN_KEYS;
+        for (int i = 0; i < right->count; i++){
+            right->keys[i] = std::move(leaf->keys[MIN_KEYS + i]);
+            right->values[i] = std::move(leaf->values[MIN_KEYS + i]);
+        }
+        leaf->count = MIN_KEYS;
+        right->next = leaf->next;
+        leaf->next = right;
+        insertIntoParents(path, pathIndex, depth, right->keys[0], right);
+        if (position > MIN_KEYS){
+            leaf = right;
+            position -= MIN_KEYS;
+        }
+    }
+
+    for (int i = leaf->count; i > position; i--){
+        leaf->keys[i] = std::move(leaf->keys[i - 1]);
+        leaf->values[i] = std::move(leaf->values[i - 1]);
+    }
+    leaf->keys[position] = std::forward<K>(key);
+    leaf->values[position] = ValueType(std::forward<Args>(args)...);
+    leaf->count++;
+    count++;
+    inserted = true;
+    return &leaf->values[position];
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::insertIntoParents(InnerNode* path[], int pathIndex[], int depth, KeyType separator, Node* right){
+    for (int level = depth - 1; level >= 0; level--){
+        InnerNode* parent = path[level];
+        int index = pathIndex[level];
+        InnerNode* target = parent;
+        InnerNode* newInner = 0;
+        KeyType upKey;
+
+        if (parent->count == MAX_KEYS){
+            /* Split the parent, its middle key goes one level up*/
+            newInner = new InnerNode;
+            newInner->leaf = false;
+            newInner->count = MAX_KEYS - MIN_KEYS - 1;
+            for (int i = 0; i < newInner->count; i++){
+                newInner->keys[i] = std::move(parent->keys[MIN_KEYS + 1 + i]);
+            }
+            for (int i = 0; i <= newInner->count; i++){
+                newInner->children[i] = parent->children[MIN_KEYS + 1 + i];
+            }
+            upKey = std::move(parent->keys[MIN_KEYS]);
+            parent->count = MIN_KEYS;
+            if (index > MIN_KEYS){
+                target = newInner;
+                index -= MIN_KEYS + 1;
+            }
+        }
+
+        for (int i = target->count; i > index; i--){
+            target->keys[i] = std::move(target->keys[i - 1]);
+            target->children[i + 1] = target->children[i];
+        }
+        target->keys[index] = std::move(separator);
+        target->children[index + 1] = right;
+        target->count++;
+
+        if (newInner == 0){
+            return;
+        }
+        separator = std::move(upKey);
+        right = newInner;
+    }
+
+    InnerNode* newRoot = new InnerNode;
+    newRoot->leaf = false;
+    newRoot->count = 1;
+    newRoot->keys[0] = std::move(separator);
+    newRoot->children[0] = root;
+    newRoot->children[1] = right;
+    root = newRoot;
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::fixUnderflow(InnerNode* path[], int pathIndex[], int depth, Node* node){
+    for (int level = depth - 1; level >= 0 && node->count < MIN_KEYS; level--){
+        InnerNode* parent = path[level];
+        int index = pathIndex[level];
+        Node* left = index > 0 ? parent->children[index - 1] : 0;
+        Node* right = index < parent->count ? parent->children[index + 1] : 0;
+
+        if (node->leaf){
+            LeafNode* leaf = static_cast<LeafNode*>(node);
+            if (right != 0 && right->count > MIN_KEYS){
+                LeafNode* rightLeaf = static_cast<LeafNode*>(right);
+                leaf->keys[leaf->count] = std::move(rightLeaf->keys[0]);
+                leaf->values[leaf->count] = std::move(rightLeaf->values[0]);
+                leaf->count++;
+                for (int i = 1; i < rightLeaf->count; i++){
+                    rightLeaf->keys[i - 1] = std::move(rightLeaf->keys[i]);
+                    rightLeaf->values[i - 1] = std::move(rightLeaf->values[i]);
+                }
+                rightLeaf->count--;
+                parent->keys[index] = rightLeaf->keys[0];
+                return;
+            }
+            if (left != 0 && left->count > MIN_KEYS){
+                LeafNode* leftLeaf = static_cast<LeafNode*>(left);
+                for (int i = leaf->count; i > 0; i--){
+                    leaf->keys[i] = std::move(leaf->keys[i - 1]);
+                    leaf->values[i] = std::move(leaf->values[i - 1]);
+                }
+                leftLeaf->count--;
+                leaf->keys[0] = std::move(leftLeaf->keys[leftLeaf->count]);
+                leaf->values[0] = std::move(leftLeaf->values[leftLeaf->count]);
+                leaf->count++;
+                parent->keys[index - 1] = leaf->keys[0];
+                return;
+            }
+            /* Merge the right one of the two leaves into the left one*/
+            if (right == 0){
+                index--;
+                right = leaf;
+                leaf = static_cast<LeafNode*>(left);
+            }
+            LeafNode* rightLeaf = static_cast<LeafNode*>(right);
+            for (int i = 0; i < rightLeaf->count; i++){
+                leaf->keys[leaf->count + i] = std::move(rightLeaf->keys[i]);
+                leaf->values[leaf->count + i] = std::move(rightLeaf->values[i]);
+            }
+            leaf->count += rightLeaf->count;
+            leaf->next = rightLeaf->next;
+            delete rightLeaf;
+        } else {
+            InnerNode* inner = static_cast<InnerNode*>(node);
+            if (right != 0 && right->count > MIN_KEYS){
+                InnerNode* rightInner = static_cast<InnerNode*>(right);
+                inner->keys[inner->count] = std::move(parent->keys[index]);
+                inner->children[inner->count + 1] = rightInner->children[0];
+                inner->count++;
+                parent->keys[index] = std::move(rightInner->keys[0]);
+                for (int i = 1; i < rightInner->count; i++){
+                    rightInner->keys[i - 1] = std::move(rightInner->keys[i]);
+                }
+                for (int i = 1; i <= rightInner->count; i++){
+                    rightInner->children[i - 1] = rightInner->children[i];
+                }
+                rightInner->count--;
+                return;
+            }
+            if (left != 0 && left->count > MIN_KEYS){
+                InnerNode* leftInner = static_cast<InnerNode*>(left);
+                for (int i = inner->count; i > 0; i--){
+                    inner->keys[i] = std::move(inner->keys[i - 1]);
+                }
+                for (int i = inner->count + 1; i > 0; i--){
+                    inner->children[i] = inner->children[i - 1];
+                }
+                inner->keys[0] = std::move(parent->keys[index - 1]);
+                inner->children[0] = leftInner->children[leftInner->count];
+                inner->count++;
+                parent->keys[index - 1] = std::move(leftInner->keys[leftInner->count - 1]);
+                leftInner->count--;
+                return;
+            }
+            /* Merge the right one of the two nodes and their separator into the left one*/
+            if (right == 0){
+                index--;
+                right = inner;
+                inner = static_cast<InnerNode*>(left);
+            }
+            InnerNode* rightInner = static_cast<InnerNode*>(right);
+            inner->keys[inner->count] = std::move(parent->keys[index]);
+            for (int i = 0; i < rightInner->count; i++){
+                inner->keys[inner->count + 1 + i] = std::move(rightInner->keys[i]);
+            }
+            for (int i = 0; i <= rightInner->count; i++){
+                inner->children[inner->count + 1 + i] = rightInner->children[i];
+            }
+            inner->count += rightInner->count + 1;
+            delete rightInner;
+        }
+
+        /* Remove the separator and the link to the merged node from the parent*/
+        for (int i = index + 1; i < parent->count; i++){
+            parent->keys[i - 1] = std::move(parent->keys[i]);
+            parent->children[i] = parent->children[i + 1];
+        }
+        parent->count--;
+        node = parent;
+    }
+
+    if (!root->leaf && root->count == 0){
+        InnerNode* oldRoot = static_cast<InnerNode*>(root);
+        root = oldRoot->children[0];
+        delete oldRoot;
+    }
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::deleteNode(Node* node){
+    if (node->leaf){
+        delete static_cast<LeafNode*>(node);
+    } else {
+        delete static_cast<InnerNode*>(node);
+    }
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::clearTree(Node* node){
+    if (node == 0){
+        return;
+    }
+    if (!node->leaf){
+        InnerNode* inner = static_cast<InnerNode*>(node);
+        for (int i = 0; i <= inner->count; i++){
+            clearTree(inner->children[i]);
+        }
+    }
+    deleteNode(node);
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::Node* BTreeMapSHPP<KeyType, ValueType>::copyTree(const Node* node, LeafNode*& lastLeaf){
+    if (node == 0){
+        return 0;
+    }
+    if (node->leaf){
+        const LeafNode* srcLeaf = static_cast<const LeafNode*>(node);
+        LeafNode* leaf = new LeafNode;
+        leaf->leaf = true;
+        leaf->count = srcLeaf->count;
+        for (int i = 0; i < srcLeaf->count; i++){
+            leaf->keys[i] = srcLeaf->keys[i];
+            leaf->values[i] = srcLeaf->values[i];
+        }
+        leaf->next = 0;
+        if (lastLeaf != 0){
+            lastLeaf->next = leaf;
+        }
+        lastLeaf = leaf;
+        return leaf;
+    }
+    const InnerNode* srcInner = static_cast<const InnerNode*>(node);
+    InnerNode* inner = new InnerNode;
+    inner->leaf = false;
+    inner->count = srcInner->count;
+    for (int i = 0; i < srcInner->count; i++){
+        inner->keys[i] = srcInner->keys[i];
+    }
+    /* Children are copied from left to right, so leaves link in order*/
+    for (int i = 0; i <= srcInner->count; i++){
+        inner->children[i] = copyTree(srcInner->children[i], lastLeaf);
+    }
+    return inner;
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::put(const KeyType& key, const ValueType& value){
+    bool inserted;
+    ValueType* place = insertEntry(key, inserted, value);
+    if (!inserted){
+        *place = value;
+    }
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::put(const KeyType& key, ValueType&& value){
+    bool inserted;
+    ValueType* place = insertEntry(key, inserted, std::move(value));
+    if (!inserted){
+        *place = std::move(value);
+    }
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::put(KeyType&& key, ValueType&& value){
+    bool inserted;
+    ValueType* place = insertEntry(std::move(key), inserted, std::move(value));
+    if (!inserted){
+        *place = std::move(value);
+    }
+}
+
+template<typename KeyType, typename ValueType>
+template<typename... Args>
+bool BTreeMapSHPP<KeyType, ValueType>::emplace(const KeyType& key, Args&&... args){
+    bool inserted;
+    insertEntry(key, inserted, std::forward<Args>(args)...);
+    return inserted;
+}
+
+template<typename KeyType, typename ValueType>
+template<typename... Args>
+bool BTreeMapSHPP<KeyType, ValueType>::emplace(KeyType&& key, Args&&... args){
+    bool inserted;
+    insertEntry(std::move(key), inserted, std::forward<Args>(args)...);
+    return inserted;
+}
+
+template<typename KeyType, typename ValueType>
+ValueType BTreeMapSHPP<KeyType, ValueType>::get(const KeyType& key){
+    iterator it = lowerBound(key);
+    if (it == end() || key < it.key()){
+        std::cout << "Error: key is not found in the map" << std::endl;
+        exit(1);
+    }
+    return it.value();
+}
+
+template<typename KeyType, typename ValueType>
+bool BTreeMapSHPP<KeyType, ValueType>::isEmpty(){
+    return count == 0;
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::clear(){
+    clearTree(root);
+    root = 0;
+    count = 0;
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::save(std::ostream& out) const{
+    SerializeSHPP::writeHeader(out, SerializeSHPP::SORTED_MAP, sizeof(KeyType), sizeof(ValueType), count);
+    if (root == 0){
+        return;
+    }
+    const Node* node = root;
+    while (!node->leaf){
+        node = static_cast<const InnerNode*>(node)->children[0];
+    }
+    for (const LeafNode* leaf = static_cast<const LeafNode*>(node); leaf != 0; leaf = leaf->next){
+        for (int i = 0; i < leaf->count; i++){
+            SerializerSHPP<KeyType>::write(out, leaf->keys[i]);
+            SerializerSHPP<ValueType>::write(out, leaf->values[i]);
+        }
+    }
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::load(std::istream& in){
+    int n = SerializeSHPP::readHeader(in, SerializeSHPP::SORTED_MAP, sizeof(KeyType), sizeof(ValueType));
+    clear();
+    for (int i = 0; i < n; i++){
+        KeyType key;
+        ValueType value;
+        SerializerSHPP<KeyType>::read(in, key);
+        SerializerSHPP<ValueType>::read(in, value);
+        SerializeSHPP::checkStream(in);
+        put(std::move(key), std::move(value));
+    }
+}
+
+template<typename KeyType, typename ValueType>
+int BTreeMapSHPP<KeyType, ValueType>::size(){
+    return count;
+}
+
+template<typename KeyType, typename ValueType>
+void BTreeMapSHPP<KeyType, ValueType>::remove(const KeyType& key){
+    if (count == 0){
+        std::cout << "Error: Map is empty" << std::endl;
+        exit(1);
+    }
+    InnerNode* path[MAX_HEIGHT];
+    int pathIndex[MAX_HEIGHT];
+    int depth;
+    LeafNode* leaf = findLeaf(key, path, pathIndex, depth);
+    int position = lowerIndex(leaf, key);
+    if (position == leaf->count || key < leaf->keys[position]){
+        return;
+    }
+
+    for (int i = position + 1; i < leaf->count; i++){
+        leaf->keys[i - 1] = std::move(leaf->keys[i]);
+        leaf->values[i - 1] = std::move(leaf->values[i]);
+    }
+    leaf->count--;
+    leaf->keys[leaf->count] = KeyType();
+    leaf->values[leaf->count] = ValueType();
+    count--;
+
+    if (count == 0){
+        clear();
+        return;
+    }
+    fixUnderflow(path, pathIndex, depth, leaf);
+}
+
+template<typename KeyType, typename ValueType>
+bool BTreeMapSHPP<KeyType, ValueType>::containsKey(const KeyType& key){
+    iterator it = lowerBound(key);
+    return it != end() && !(key < it.key());
+}
+
+template<typename KeyType, typename ValueType>
+ValueType& BTreeMapSHPP<KeyType, ValueType>::operator [](const KeyType& key){
+    bool inserted;
+    return *insertEntry(key, inserted);
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::iterator BTreeMapSHPP<KeyType, ValueType>::begin(){
+    if (root == 0){
+        return end();
+    }
+    Node* node = root;
+    while (!node->leaf){
+        node = static_cast<InnerNode*>(node)->children[0];
+    }
+    return iterator(static_cast<LeafNode*>(node), 0);
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::iterator BTreeMapSHPP<KeyType, ValueType>::end(){
+    return iterator();
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::iterator BTreeMapSHPP<KeyType, ValueType>::lowerBound(const KeyType& key){
+    if (root == 0){
+        return end();
+    }
+    Node* node = root;
+    while (!node->leaf){
+        node = static_cast<InnerNode*>(node)->children[upperIndex(node, key)];
+    }
+    return iterator(static_cast<LeafNode*>(node), lowerIndex(node, key));
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::iterator BTreeMapSHPP<KeyType, ValueType>::upperBound(const KeyType& key){
+    if (root == 0){
+        return end();
+    }
+    Node* node = root;
+    while (!node->leaf){
+        node = static_cast<InnerNode*>(node)->children[upperIndex(node, key)];
+    }
+    return iterator(static_cast<LeafNode*>(node), upperIndex(node, key));
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::Range BTreeMapSHPP<KeyType, ValueType>::range(const KeyType& lo, const KeyType& hi){
+    if (!(lo < hi)){
+        return Range(end(), end());
+    }
+    return Range(lowerBound(lo), lowerBound(hi));
+}
+
+/* Implementation of all methods of BTreeMapSHPP::iterator class*/
+template<typename KeyType, typename ValueType>
+BTreeMapSHPP<KeyType, ValueType>::iterator::iterator(){
+    leaf = 0;
+    index = 0;
+}
+
+template<typename KeyType, typename ValueType>
+BTreeMapSHPP<KeyType, ValueType>::iterator::iterator(LeafNode* leaf, int index){
+    /* Position past the end of a leaf means the start of the next one*/
+    while (leaf != 0 && index == leaf->count){
+        leaf = leaf->next;
+        index = 0;
+    }
+    this->leaf = leaf;
+    this->index = index;
+}
+
+template<typename KeyType, typename ValueType>
+const KeyType& BTreeMapSHPP<KeyType, ValueType>::iterator::key() const{
+    return leaf->keys[index];
+}
+
+template<typename KeyType, typename ValueType>
+ValueType& BTreeMapSHPP<KeyType, ValueType>::iterator::value() const{
+    return leaf->values[index];
+}
+
+template<typename KeyType, typename ValueType>
+const KeyType& BTreeMapSHPP<KeyType, ValueType>::iterator::operator *() const{
+    return leaf->keys[index];
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::iterator& BTreeMapSHPP<KeyType, ValueType>::iterator::operator ++(){
+    index++;
+    if (index == leaf->count){
+        leaf = leaf->next;
+        index = 0;
+    }
+    return *this;
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::iterator BTreeMapSHPP<KeyType, ValueType>::iterator::operator ++(int){
+    iterator previous = *this;
+    ++(*this);
+    return previous;
+}
+
+template<typename KeyType, typename ValueType>
+bool BTreeMapSHPP<KeyType, ValueType>::iterator::operator ==(const iterator& other) const{
+    return leaf == other.leaf && index == other.index;
+}
+
+template<typename KeyType, typename ValueType>
+bool BTreeMapSHPP<KeyType, ValueType>::iterator::operator !=(const iterator& other) const{
+    return !(*this == other);
+}
+
+template<typename KeyType, typename ValueType>
+BTreeMapSHPP<KeyType, ValueType>::Range::Range(const iterator& first, const iterator& last){
+    this->first = first;
+    this->last = last;
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::iterator BTreeMapSHPP<KeyType, ValueType>::Range::begin() const{
+    return first;
+}
+
+template<typename KeyType, typename ValueType>
+typename BTreeMapSHPP<KeyType, ValueType>::iterator BTreeMapSHPP<KeyType, ValueType>::Range::end() const{
+    return last;
+}
+
+#endif // BTREEMAPSHPP_H
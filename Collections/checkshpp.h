@@ -0,0 +1,55 @@
+/* File: checkshpp.h
+ * -----------------------------------
+ *
+ * This file exports the policy of checking
+ * indexes and empty containers in the SHPP
+ * collections.
+ */
+
+#ifndef CHECKSHPP_H
+#define CHECKSHPP_H
+
+#include <iostream>
+#include <stdlib.h>
+#include <assert.h>
+
+/* Levels of the checks:
+ *   SHPP_CHECKED    wrong index or empty container prints the
+ *                   error and exits the program (default)
+ *   SHPP_ASSERT     the same mistakes stop the program by assert,
+ *                   so builds with NDEBUG have no checks at all
+ *   SHPP_UNCHECKED  no checks, accessors are bare loads and stores
+ * Define SHPP_BOUNDS_CHECK to one of them before including any
+ * collection, for example -DSHPP_BOUNDS_CHECK=SHPP_ASSERT.
+ */
+#define SHPP_UNCHECKED 0
+#define SHPP_ASSERT 1
+#define SHPP_CHECKED 2
+
+#ifndef SHPP_BOUNDS_CHECK
+#define SHPP_BOUNDS_CHECK SHPP_CHECKED
+#endif
+
+/* Macro: SHPP_REQUIRE
+ * Usage: SHPP_REQUIRE(index >= 0 && index < count, "Fatal error: index is not valid");
+ * -----------------------------------------------------
+ * Checks the condition according to SHPP_BOUNDS_CHECK. Without
+ * checks the condition is not evaluated
+ */
+#if SHPP_BOUNDS_CHECK == SHPP_CHECKED
+#define SHPP_REQUIRE(condition, message) \
+    do { \
+        if (!(condition)){ \
+            std::cout << message << std::endl; \
+            exit(1); \
+        } \
+    } while (0)
+#elif SHPP_BOUNDS_CHECK == SHPP_ASSERT
+#define SHPP_REQUIRE(condition, message) assert((condition) && message)
+#elif SHPP_BOUNDS_CHECK == SHPP_UNCHECKED
+#define SHPP_REQUIRE(condition, message) ((void)0)
+#else
+#error "SHPP_BOUNDS_CHECK must be SHPP_CHECKED, SHPP_ASSERT or SHPP_UNCHECKED"
+#endif
+
+#endif // CHECKSHPP_H
@@ -0,0 +1,292 @@
+/* File: concurrentmapshpp.h
+ * --------------------------------------------------
+ * This interface exports a thread-safe version of map
+ * that spreads the keys over several independently
+ * locked MapSHPP shards. Needs C++14 (shared_timed_mutex).
+ */
+#ifndef CONCURRENTMAPSHPP_H
+#define CONCURRENTMAPSHPP_H
+
+#include <iostream>
+#include <stdlib.h>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include "mapshpp.h"
+
+
+/* Class: ConcurrentMapSHPP
+ * -------------------------------------------------
+ * This class implements map of a specified ValueType
+ * elements that may be used from many threads at once.
+ * Every key belongs to one shard chosen by its hash. Readers
+ * of a shard share its lock, writers take it exclusively,
+ * so operations on different shards never wait for each other.
+ * Values are returned by copy, because a link could outlive
+ * the lock.
+ */
+template<typename KeyType, typename ValueType, typename Hash = std::hash<KeyType> >
+class ConcurrentMapSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: ConcurrentMapSHPP
+     * Usage: ConcurrentMapSHPP<KeyType, ValueType> map;
+     *        ConcurrentMapSHPP<KeyType, ValueType> map(256);
+     * -----------------------------------------------------
+     * Initializes a new empty map with the received number
+     * of shards, rounded up to the power of two
+     */
+    explicit ConcurrentMapSHPP(int shards = DEFAULT_SHARDS, const Hash& hash = Hash());
+
+    /* Destructor: ~ConcurrentMapSHPP
+    * ----------------------------------------------
+    * Frees all allocated memory for the map elements
+    */
+    virtual ~ConcurrentMapSHPP();
+
+    /* Method: put
+     * Usage: map.put(key, value);
+     * -----------------------------------------------
+     * Put the value in accordance with the key.
+     * If this key already exists then its value is replaced by a new
+     */
+    void put(const KeyType& key, const ValueType& value);
+    void put(KeyType&& key, ValueType&& value);
+
+    /* Method: get
+     * Usage: value = map.get(key);
+     * -----------------------------------------------
+     * Returns copy of the value of the corresponding key
+     */
+    ValueType get(const KeyType& key);
+
+    /* Method: tryGet
+     * Usage: if (map.tryGet(key, value))...
+     * -----------------------------------------------
+     * Copies the value of the key to the received variable
+     * and returns true, or returns false if the key is absent
+     */
+    bool tryGet(const KeyType& key, ValueType& value);
+
+    /* Method: containsKey
+     * Usage: if (map.containsKey(key))
+     * -----------------------------------------------------
+     * Return true if map contains input key
+     */
+    bool containsKey(const KeyType& key);
+
+    /* Method: remove
+     * Usage: map.remove(key);
+     * -----------------------------------------------------
+     * Removes value of the map corresponding to the key,
+     * does nothing if the key is absent
+     */
+    void remove(const KeyType& key);
+
+    /* Method: computeIfAbsent
+     * Usage: value = map.computeIfAbsent(key, [](const KeyType& key) { return ...; });
+     * -----------------------------------------------------
+     * Returns the value of the key. If the key is absent
+     * puts the result of compute(key) first. The check and
+     * the insert are atomic, compute is called at most once
+     */
+    template<typename Compute>
+    ValueType computeIfAbsent(const KeyType& key, Compute compute);
+
+    /* Method: upsert
+     * Usage: map.upsert(key, 1, [](ValueType& value) { value++; });
+     * -----------------------------------------------------
+     * Atomically puts the received value if the key is absent,
+     * otherwise calls update with link to the stored value
+     */
+    template<typename Update>
+    void upsert(const KeyType& key, const ValueType& value, Update update);
+
+    /* Method: size
+     * Usage: int size = map.size();
+     * --------------------------------------------
+     * Return current number of the elements of the
+     * map. Shards are counted one by one, so under
+     * concurrent updates the result is approximate
+     */
+    int size();
+
+    /* Method: isEmpty
+     * Usage: if (map.isEmpty());
+     * -----------------------------------------------
+     * Returns true if map is empty
+     */
+    bool isEmpty();
+
+    /* Method: clear
+     * Usage: map.clear();
+     * ---------------------------------------------
+     * Removes all elements of the map
+     */
+    void clear();
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Default number of the shards*/
+    static const int DEFAULT_SHARDS = 64;
+
+    /* Size of the cache line*/
+    static const int CACHE_LINE = 64;
+
+    /* Part of the map with its own lock. Padding keeps locks of
+     * neighbouring shards in different cache lines*/
+    struct Shard {
+        std::shared_timed_mutex lock;
+        MapSHPP<KeyType, ValueType> map;
+        char padding[CACHE_LINE];
+    };
+
+    /* Forbid copying, shards own their locks*/
+    ConcurrentMapSHPP(const ConcurrentMapSHPP& src);
+    ConcurrentMapSHPP& operator=(const ConcurrentMapSHPP& src);
+
+    /* Method: shardFor
+     * -----------------------------------------------
+     * Returns the shard that holds received key
+     */
+    Shard& shardFor(const KeyType& key);
+
+    /* Array of the shards*/
+    Shard* shards;
+
+    /* Number of the shards, power of two*/
+    int shardCount;
+
+    /* Right shift that turns mixed hash into shard index*/
+    int shift;
+
+    /* Hash function object*/
+    Hash hasher;
+};
+
+
+template<typename KeyType, typename ValueType, typename Hash>
+ConcurrentMapSHPP<KeyType, ValueType, Hash>::ConcurrentMapSHPP(int shards, const Hash& hash) : hasher(hash){
+    shardCount = 1;
+    shift = 64;
+    while (shardCount < shards){
+        shardCount *= 2;
+        shift--;
+    }
+    this->shards = new Shard[shardCount];
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+ConcurrentMapSHPP<KeyType, ValueType, Hash>::~ConcurrentMapSHPP(){
+    delete[] shards;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+typename ConcurrentMapSHPP<KeyType, ValueType, Hash>::Shard& ConcurrentMapSHPP<KeyType, ValueType, Hash>::shardFor(const KeyType& key){
+    if (shardCount == 1){
+        return shards[0];
+    }
+    /* Fibonacci hashing spreads weak hashes such as identity of ints*/
+    unsigned long long mixed = (unsigned long long)hasher(key) * 11400714819323198485ull;
+    return shards[mixed >> shift];
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void ConcurrentMapSHPP<KeyType, ValueType, Hash>::put(const KeyType& key, const ValueType& value){
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::shared_timed_mutex> guard(shard.lock);
+    shard.map.put(key, value);
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void ConcurrentMapSHPP<KeyType, ValueType, Hash>::put(KeyType&& key, ValueType&& value){
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::shared_timed_mutex> guard(shard.lock);
+    shard.map.put(std::move(key), std::move(value));
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+ValueType ConcurrentMapSHPP<KeyType, ValueType, Hash>::get(const KeyType& key){
+    Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_timed_mutex> guard(shard.lock);
+    return shard.map.get(key);
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+bool ConcurrentMapSHPP<KeyType, ValueType, Hash>::tryGet(const KeyType& key, ValueType& value){
+    Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_timed_mutex> guard(shard.lock);
+    return shard.map.computeIfPresent(key, [&value](const ValueType& stored) { value = stored; });
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+bool ConcurrentMapSHPP<KeyType, ValueType, Hash>::containsKey(const KeyType& key){
+    Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_timed_mutex> guard(shard.lock);
+    return shard.map.containsKey(key);
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void ConcurrentMapSHPP<KeyType, ValueType, Hash>::remove(const KeyType& key){
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::shared_timed_mutex> guard(shard.lock);
+    if (!shard.map.isEmpty()){
+        shard.map.remove(key);
+    }
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+template<typename Compute>
+ValueType ConcurrentMapSHPP<KeyType, ValueType, Hash>::computeIfAbsent(const KeyType& key, Compute compute){
+    ValueType value;
+    if (tryGet(key, value)){
+        return value;
+    }
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::shared_timed_mutex> guard(shard.lock);
+    if (!shard.map.computeIfPresent(key, [&value](const ValueType& stored) { value = stored; })){
+        value = compute(key);
+        shard.map.put(key, value);
+    }
+    return value;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+template<typename Update>
+void ConcurrentMapSHPP<KeyType, ValueType, Hash>::upsert(const KeyType& key, const ValueType& value, Update update){
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::shared_timed_mutex> guard(shard.lock);
+    std::pair<ValueType&, bool> result = shard.map.tryEmplace(key, value);
+    if (!result.second){
+        update(result.first);
+    }
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+int ConcurrentMapSHPP<KeyType, ValueType, Hash>::size(){
+    int total = 0;
+    for (int i = 0; i < shardCount; i++){
+        std::shared_lock<std::shared_timed_mutex> guard(shards[i].lock);
+        total += shards[i].map.size();
+    }
+    return total;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+bool ConcurrentMapSHPP<KeyType, ValueType, Hash>::isEmpty(){
+    return size() == 0;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void ConcurrentMapSHPP<KeyType, ValueType, Hash>::clear(){
+    for (int i = 0; i < shardCount; i++){
+        std::lock_guard<std::shared_timed_mutex> guard(shards[i].lock);
+        shards[i].map.clear();
+    }
+}
+
+#endif // CONCURRENTMAPSHPP_H
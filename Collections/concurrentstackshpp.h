@@ -0,0 +1,272 @@
+/* File: concurrentstackshpp.h
+ * -----------------------------------
+ *
+ * This file exports a lock free stack shared
+ * by many threads.
+ */
+
+#ifndef CONCURRENTSTACKSHPP_H
+#define CONCURRENTSTACKSHPP_H
+
+#include <atomic>
+#include <stdint.h>
+#include <utility>
+#include "epochshpp.h"
+
+/* Class ConcurrentStackSHPP<ValueType>
+ * --------------------------------
+ * This class implements a Treiber stack: a linked list whose top
+ * is replaced by compare and swap. The top word keeps a 16 bit tag
+ * in the upper bits of the pointer, unused by 64 bit user space
+ * addresses, and every change increases it, so a top that was
+ * popped and pushed back does not look unchanged. Popped nodes are
+ * freed through EpochSHPP, because other threads may still read
+ * them. A push or pop that loses the race for the top tries the
+ * elimination array: a pusher offers its node in a random slot for
+ * a short time and a failed pop takes an offered node, so the pair
+ * completes without touching the top.
+ */
+template <typename ValueType>
+class ConcurrentStackSHPP {
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: ConcurrentStackSHPP
+     * Usage: ConcurrentStackSHPP<ValueType> stack;
+     * -----------------------------------------------------
+     * Initializes a new empty stack
+     */
+    ConcurrentStackSHPP();
+
+    /* Destructor: ~ConcurrentStackSHPP
+     * -----------------------------------------------------
+     * Frees all nodes. No thread may use the stack at this moment
+     */
+    virtual ~ConcurrentStackSHPP();
+
+    /* Method: push
+     * Usage: stack.push(value);
+     * -----------------------------------------------------
+     * Pushes the specified value on the stack
+     */
+    void push(ValueType value);
+
+    /* Method: tryPop
+     * Usage: if (stack.tryPop(value))...
+     * ----------------------------------------------------
+     * Removes top element of the stack and moves it to value.
+     * Returns false if the stack is empty
+     */
+    bool tryPop(ValueType& value);
+
+    /* Method: isEmpty
+     * Usage: if (stack.isEmpty())...
+     * -----------------------------------------------------
+     * Returns true if stack is empty. Other threads may change
+     * it at any moment, so the result is only a hint
+     */
+    bool isEmpty() const;
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    static_assert(sizeof(void*) == 8, "ConcurrentStackSHPP keeps a tag in the upper bits of 64 bit pointers");
+
+    /* Number of the slots of the elimination array*/
+    static const int ELIMINATION_SLOTS = 8;
+
+    /* Number of checks a pusher waits in a slot for a pop*/
+    static const int ELIMINATION_SPINS = 128;
+
+    /* Size of the cache line*/
+    static const int CACHE_LINE = 64;
+
+    /* Bits of the pointer in the top word*/
+    static const int POINTER_BITS = 48;
+
+    struct Node {
+        ValueType value;
+        Node *next;
+    };
+
+    /* Slot of the elimination array, holds an offered node or 0*/
+    struct Slot {
+        std::atomic<Node*> node;
+        char padding[CACHE_LINE - sizeof(std::atomic<Node*>)];
+    };
+
+    /* Forbid copying, the stack is shared by many threads*/
+    ConcurrentStackSHPP(const ConcurrentStackSHPP<ValueType>& src);
+    ConcurrentStackSHPP<ValueType>& operator=(const ConcurrentStackSHPP<ValueType>& src);
+
+    /* Method: pack, pointer
+     * ------------------------------------------------
+     * Build the top word and take the node out of it
+     */
+    static uint64_t pack(Node *node, uint64_t tag);
+    static Node *pointer(uint64_t word);
+
+    /* Method: offer
+     * Usage: if (offer(node))...
+     * ------------------------------------------------
+     * Offers the node in a random slot for a short time.
+     * Returns true if a pop took it
+     */
+    bool offer(Node *node);
+
+    /* Method: take
+     * Usage: Node *node = take();
+     * ------------------------------------------------
+     * Takes the node offered in a random slot, returns 0
+     * if the slot is empty
+     */
+    Node *take();
+
+    /* Method: randomSlot
+     * Usage: Slot& slot = randomSlot();
+     * ------------------------------------------------
+     * Returns a slot picked by the generator of the thread
+     */
+    Slot& randomSlot();
+
+    /* Method: destroyNode
+     * ------------------------------------------------
+     * Frees the node retired to EpochSHPP
+     */
+    static void destroyNode(void *node);
+
+    char frontPadding[CACHE_LINE];
+
+    /* Tagged pointer to the top node*/
+    std::atomic<uint64_t> top;
+
+    char topPadding[CACHE_LINE];
+
+    /* Elimination array*/
+    Slot slots[ELIMINATION_SLOTS];
+};
+
+
+/* Implementation of all methods of ConcurrentStackSHPP class*/
+
+template <typename ValueType>
+ConcurrentStackSHPP<ValueType>::ConcurrentStackSHPP(){
+    top.store(0);
+    for (int i = 0; i < ELIMINATION_SLOTS; i++){
+        slots[i].node.store(0);
+    }
+}
+
+template <typename ValueType>
+ConcurrentStackSHPP<ValueType>::~ConcurrentStackSHPP(){
+    Node *node = pointer(top.load());
+    while (node != 0){
+        Node *next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+template <typename ValueType>
+uint64_t ConcurrentStackSHPP<ValueType>::pack(Node *node, uint64_t tag){
+    return (uint64_t)(uintptr_t)node | (tag << POINTER_BITS);
+}
+
+template <typename ValueType>
+typename ConcurrentStackSHPP<ValueType>::Node *ConcurrentStackSHPP<ValueType>::pointer(uint64_t word){
+    return reinterpret_cast<Node*>((uintptr_t)(word & (((uint64_t)1 << POINTER_BITS) - 1)));
+}
+
+template <typename ValueType>
+void ConcurrentStackSHPP<ValueType>::push(ValueType value){
+    Node *node = new Node{std::move(value), 0};
+    uint64_t oldTop = top.load(std::memory_order_relaxed);
+    while (true){
+        node->next = pointer(oldTop);
+        if (top.compare_exchange_weak(oldTop, pack(node, (oldTop >> POINTER_BITS) + 1))){
+            return;
+        }
+        if (offer(node)){
+            return;
+        }
+        oldTop = top.load(std::memory_order_relaxed);
+    }
+}
+
+template <typename ValueType>
+bool ConcurrentStackSHPP<ValueType>::tryPop(ValueType& value){
+    EpochSHPP::Guard guard;
+    uint64_t oldTop = top.load();
+    while (true){
+        Node *node = pointer(oldTop);
+        if (node == 0){
+            return false;
+        }
+        /* The node can not be freed inside the critical section*/
+        if (top.compare_exchange_weak(oldTop, pack(node->next, (oldTop >> POINTER_BITS) + 1))){
+            value = std::move(node->value);
+            EpochSHPP::shared().retire(node, destroyNode);
+            return true;
+        }
+        Node *offered = take();
+        if (offered != 0){
+            /* Offered nodes were never on the stack, nobody else sees them*/
+            value = std::move(offered->value);
+            delete offered;
+            return true;
+        }
+        oldTop = top.load();
+    }
+}
+
+template <typename ValueType>
+bool ConcurrentStackSHPP<ValueType>::isEmpty() const{
+    return pointer(top.load()) == 0;
+}
+
+template <typename ValueType>
+bool ConcurrentStackSHPP<ValueType>::offer(Node *node){
+    Slot& slot = randomSlot();
+    Node *expected = 0;
+    if (!slot.node.compare_exchange_strong(expected, node, std::memory_order_release, std::memory_order_relaxed)){
+        return false;
+    }
+    for (int i = 0; i < ELIMINATION_SPINS; i++){
+        if (slot.node.load(std::memory_order_relaxed) != node){
+            return true;
+        }
+    }
+    expected = node;
+    /* Taking the node back fails if a pop has just taken it*/
+    return !slot.node.compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+}
+
+template <typename ValueType>
+typename ConcurrentStackSHPP<ValueType>::Node *ConcurrentStackSHPP<ValueType>::take(){
+    Slot& slot = randomSlot();
+    Node *node = slot.node.load(std::memory_order_relaxed);
+    if (node == 0 || !slot.node.compare_exchange_strong(node, 0, std::memory_order_acquire, std::memory_order_relaxed)){
+        return 0;
+    }
+    return node;
+}
+
+template <typename ValueType>
+typename ConcurrentStackSHPP<ValueType>::Slot& ConcurrentStackSHPP<ValueType>::randomSlot(){
+    static thread_local uint32_t state = 0;
+    if (state == 0){
+        state = (uint32_t)(uintptr_t)&state | 1;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return slots[state % ELIMINATION_SLOTS];
+}
+
+template <typename ValueType>
+void ConcurrentStackSHPP<ValueType>::destroyNode(void *node){
+    delete static_cast<Node*>(node);
+}
+
+#endif // CONCURRENTSTACKSHPP_H
@@ -9,6 +9,8 @@
 
 #include <iostream>
 #include <stdlib.h>
+#include "checkshpp.h"
+#include "serializeshpp.h"
 
 /* Class: Deque<ValueType> deque;
  * ---------------------------------------------------
@@ -97,6 +99,22 @@ public:
    */
     void clear();
 
+    /* Method: save
+   * Usage: deque.save(out);
+   * ---------------------------------------------
+   * Writes all elements from the front to the back
+   * to the binary stream
+   */
+    void save(std::ostream& out) const;
+
+    /* Method: load
+   * Usage: deque.load(in);
+   * ---------------------------------------------
+   * Replaces the content of the deque by the elements
+   * read from the binary stream written by save
+   */
+    void load(std::istream& in);
+
 
     /* Private methods prototypes and instase variables*/
 private:
@@ -182,12 +200,11 @@ void DequeSHPP<ValueType>::moveArrayBack(Section* first){
 
 template <typename ValueType>
 void DequeSHPP<ValueType>::pushBack(ValueType value){
-    if(currentSize == 0){
+    if(first == 0){
         last = first = createSection();
     }
     if(last->count == ARRAY_SIZE){
-        Section* list = new Section;
-        list = last;
+        Section* list = last;
         last = createSection();
         last->left = list;
         list->right = last;
@@ -202,12 +219,11 @@ void DequeSHPP<ValueType>::pushBack(ValueType value){
 
 template <typename ValueType>
 void DequeSHPP<ValueType>::pushFront(ValueType value){
-    if(currentSize == 0){
+    if(first == 0){
         last = first = createSection();
     }
     if(first->count == ARRAY_SIZE){
-        Section* list = new Section;
-        list = first;
+        Section* list = first;
         first = createSection();
         first->right = list;
         list->left = first;
@@ -223,57 +239,47 @@ void DequeSHPP<ValueType>::pushFront(ValueType value){
 
 template <typename ValueType>
 ValueType DequeSHPP<ValueType>::popBack(){
-    if(currentSize != 0){
-        ValueType value = last->array[last->count - 1];
-        last->count--;
-        currentSize--;
-        if(last->count == 0 && currentSize != 0){
-            last = last->left;
-            last->right = 0;
-        }
-        return value;
-    } else {
-        std::cout << "Error: Deque is empty" << std::endl;
-        exit(1);
+    SHPP_REQUIRE(currentSize != 0, "Error: Deque is empty");
+    ValueType value = last->array[last->count - 1];
+    last->count--;
+    currentSize--;
+    if(last->count == 0 && currentSize != 0){
+        Section* empty = last;
+        last = last->left;
+        last->right = 0;
+        delete[] empty->array;
+        delete empty;
     }
+    return value;
 }
 
 template <typename ValueType>
 ValueType DequeSHPP<ValueType>::popFront(){
-    if(currentSize != 0){
-        ValueType value = first->array[0];
-        first->count--;
-        currentSize--;
-        moveArrayBack(first);
-        if(first->count == 0){
-            first = first->right;
-            first->left = 0;
-        }
-        return value;
-    } else {
-        std::cout << "Error: Deque is empty" << std::endl;
-        exit(1);
+    SHPP_REQUIRE(currentSize != 0, "Error: Deque is empty");
+    ValueType value = first->array[0];
+    first->count--;
+    currentSize--;
+    moveArrayBack(first);
+    if(first->count == 0 && currentSize != 0){
+        Section* empty = first;
+        first = first->right;
+        first->left = 0;
+        delete[] empty->array;
+        delete empty;
     }
+    return value;
 }
 
 template <typename ValueType>
 ValueType DequeSHPP<ValueType>::front()const{
-    if(currentSize != 0){
-        return first->array[0];
-    } else {
-        std::cout << "Error: Deque is empty" << std::endl;
-        exit(1);
-    }
+    SHPP_REQUIRE(currentSize != 0, "Error: Deque is empty");
+    return first->array[0];
 }
 
 template <typename ValueType>
 ValueType DequeSHPP<ValueType>::back()const{
-    if(currentSize != 0){
-        return last->array[last->count - 1];
-    } else {
-        std::cout << "Error: Deque is empty" << std::endl;
-        exit(1);
-    }
+    SHPP_REQUIRE(currentSize != 0, "Error: Deque is empty");
+    return last->array[last->count - 1];
 }
 
 template <typename ValueType>
@@ -288,14 +294,44 @@ int DequeSHPP<ValueType>::size()const {
 
 template <typename ValueType>
 void DequeSHPP<ValueType>::clear() {
-    while (first->right != 0) {
-        Section* tmp = new Section;
-        tmp = first;
+    while (first != 0) {
+        Section* tmp = first;
         first = first->right;
+        delete[] tmp->array;
         delete tmp;
     }
-    delete first;
+    last = 0;
     currentSize = 0;
 }
 
+template <typename ValueType>
+void DequeSHPP<ValueType>::save(std::ostream& out) const {
+    SerializeSHPP::writeHeader(out, SerializeSHPP::DEQUE, 0, sizeof(ValueType), currentSize);
+    for (Section* section = first; section != 0 && currentSize != 0; section = section->right) {
+        SerializerSHPP<ValueType>::writeArray(out, section->array, section->count);
+    }
+}
+
+template <typename ValueType>
+void DequeSHPP<ValueType>::load(std::istream& in) {
+    int n = SerializeSHPP::readHeader(in, SerializeSHPP::DEQUE, 0, sizeof(ValueType));
+    clear();
+    /* Elements are read straight into full sections*/
+    while (n > 0) {
+        Section* section = createSection();
+        section->count = n < ARRAY_SIZE ? n : ARRAY_SIZE;
+        SerializerSHPP<ValueType>::readArray(in, section->array, section->count);
+        if (last == 0) {
+            first = last = section;
+        } else {
+            last->right = section;
+            section->left = last;
+            last = section;
+        }
+        currentSize += section->count;
+        n -= section->count;
+    }
+    SerializeSHPP::checkStream(in);
+}
+
 #endif
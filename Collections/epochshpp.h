@@ -0,0 +1,277 @@
+/* File: epochshpp.h
+ * -----------------------------------------------------
+ * This file exports epoch based reclamation of memory
+ * shared by lock free collections.
+ */
+
+#ifndef EPOCHSHPP_H
+#define EPOCHSHPP_H
+
+#include <atomic>
+#include <iostream>
+#include <stdlib.h>
+#include "vectorshpp.h"
+
+/* Class: EpochSHPP
+ * ---------------------------------------------------
+ * A lock free collection can not free a node right after unlinking
+ * it, because other threads may still read it. Threads read shared
+ * nodes only inside a critical section, marked by EpochSHPP::Guard,
+ * and hand unlinked nodes to retire. The global epoch moves forward
+ * only when every thread inside a critical section has seen its
+ * current value. A node is tagged with the epoch read after it was
+ * unlinked; every thread that could reach it entered its critical
+ * section at this epoch or earlier and holds the global epoch from
+ * moving two steps past it, so the node is freed once the epoch is
+ * two steps ahead of the tag. Each thread keeps its retired nodes in
+ * three lists, one per the last three epochs, and frees the oldest
+ * list when it becomes safe. All collections share one instance.
+ */
+class EpochSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Class: Guard
+     * Usage: EpochSHPP::Guard guard;
+     * -----------------------------------------------------
+     * Marks the critical section of the current thread for the
+     * lifetime of the object. Guards may be nested
+     */
+    class Guard{
+    public:
+        Guard(){
+            EpochSHPP::shared().enter();
+        }
+        ~Guard(){
+            EpochSHPP::shared().leave();
+        }
+    private:
+        Guard(const Guard& src);
+        Guard& operator=(const Guard& src);
+    };
+
+    /* Method: shared
+     * Usage: EpochSHPP& epoch = EpochSHPP::shared();
+     * -----------------------------------------------------
+     * Returns the instance used by all collections
+     */
+    static EpochSHPP& shared(){
+        static EpochSHPP epoch;
+        return epoch;
+    }
+
+    /* Method: retire
+     * Usage: EpochSHPP::shared().retire(node, destroy);
+     * -----------------------------------------------------
+     * Calls destroy(object) when no thread can read the object any
+     * more. The object must already be unlinked from the collection.
+     * Called inside a critical section
+     */
+    void retire(void *object, void (*destroy)(void*));
+
+    /* Destructor: ~EpochSHPP
+     * -----------------------------------------------------
+     * Frees all retired objects, no thread works at this moment
+     */
+    virtual ~EpochSHPP();
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Maximal number of threads using the collections at once*/
+    static const int MAX_THREADS = 256;
+
+    /* Number of retired objects between attempts to move the epoch*/
+    static const int ADVANCE_PERIOD = 64;
+
+    /* Size of the cache line*/
+    static const int CACHE_LINE = 64;
+
+    /* Object waiting to be freed*/
+    struct Retired {
+        void *object;
+        void (*destroy)(void*);
+    };
+
+    /* Retired objects tagged by one epoch*/
+    struct Limbo {
+        VectorSHPP<Retired> objects;
+        unsigned epoch;
+    };
+
+    /* State of one thread. Only the owner changes nesting and
+     * limbo lists, others read active and epoch*/
+    struct Record {
+        std::atomic<bool> used;
+        std::atomic<bool> active;
+        std::atomic<unsigned> epoch;
+        int nesting;
+        int retiredCount;
+        Limbo limbo[3];
+        char padding[CACHE_LINE];
+    };
+
+    /* Releases the record when its thread finishes. Retired
+     * objects stay in the record for the next owner*/
+    struct Owner {
+        Record *record;
+        Owner() : record(0) {}
+        ~Owner(){
+            if (record != 0){
+                record->used.store(false);
+            }
+        }
+    };
+
+    EpochSHPP();
+    EpochSHPP(const EpochSHPP& src);
+    EpochSHPP& operator=(const EpochSHPP& src);
+
+    /* Method: enter, leave
+     * ------------------------------------------------
+     * Begin and end the critical section of the current thread
+     */
+    void enter();
+    void leave();
+
+    /* Method: record
+     * Usage: Record *record = record();
+     * ------------------------------------------------
+     * Returns the record of the current thread, taking a free
+     * one on the first call
+     */
+    Record *record();
+
+    /* Method: tryAdvance
+     * Usage: tryAdvance();
+     * ------------------------------------------------
+     * Moves the global epoch if all threads inside critical
+     * sections have seen it
+     */
+    void tryAdvance();
+
+    /* Method: freeLimbo
+     * Usage: freeLimbo(limbo);
+     * ------------------------------------------------
+     * Destroys all objects of the list
+     */
+    static void freeLimbo(Limbo& limbo);
+
+    /* Epoch of the whole process, grows by one*/
+    std::atomic<unsigned> globalEpoch;
+
+    char epochPadding[CACHE_LINE];
+
+    /* Records of the threads, used ones are below recordCount*/
+    Record records[MAX_THREADS];
+    std::atomic<int> recordCount;
+};
+
+
+/* Implementation of all methods of EpochSHPP class*/
+inline EpochSHPP::EpochSHPP(){
+    globalEpoch.store(0);
+    recordCount.store(0);
+    for (int i = 0; i < MAX_THREADS; i++){
+        records[i].used.store(false);
+        records[i].active.store(false);
+        records[i].epoch.store(0);
+        records[i].nesting = 0;
+        records[i].retiredCount = 0;
+        for (int j = 0; j < 3; j++){
+            records[i].limbo[j].epoch = 0;
+        }
+    }
+}
+
+inline EpochSHPP::~EpochSHPP(){
+    for (int i = 0; i < MAX_THREADS; i++){
+        for (int j = 0; j < 3; j++){
+            freeLimbo(records[i].limbo[j]);
+        }
+    }
+}
+
+inline EpochSHPP::Record *EpochSHPP::record(){
+    static thread_local Owner owner;
+    if (owner.record == 0){
+        for (int i = 0; i < MAX_THREADS; i++){
+            bool expected = false;
+            if (!records[i].used.load() && records[i].used.compare_exchange_strong(expected, true)){
+                owner.record = records + i;
+                int count = recordCount.load();
+                while (count < i + 1 && !recordCount.compare_exchange_weak(count, i + 1)){
+                }
+                break;
+            }
+        }
+        if (owner.record == 0){
+            std::cout << "Fatal error: too many threads use lock free collections" << std::endl;
+            exit(1);
+        }
+    }
+    return owner.record;
+}
+
+inline void EpochSHPP::enter(){
+    Record *current = record();
+    if (current->nesting++ > 0){
+        return;
+    }
+    current->epoch.store(globalEpoch.load());
+    current->active.store(true);
+}
+
+inline void EpochSHPP::leave(){
+    Record *current = record();
+    if (--current->nesting == 0){
+        current->active.store(false, std::memory_order_release);
+    }
+}
+
+inline void EpochSHPP::retire(void *object, void (*destroy)(void*)){
+    Record *current = record();
+    /* Read after the object was unlinked, see the class comment*/
+    unsigned epoch = globalEpoch.load();
+    Limbo& limbo = current->limbo[epoch % 3];
+    if (limbo.epoch != epoch){
+        /* The list holds objects at least three epochs old*/
+        freeLimbo(limbo);
+        limbo.epoch = epoch;
+    }
+    Retired retired;
+    retired.object = object;
+    retired.destroy = destroy;
+    limbo.objects.add(retired);
+    if (++current->retiredCount >= ADVANCE_PERIOD){
+        current->retiredCount = 0;
+        tryAdvance();
+        unsigned now = globalEpoch.load();
+        for (int i = 0; i < 3; i++){
+            if (now - current->limbo[i].epoch >= 2){
+                freeLimbo(current->limbo[i]);
+            }
+        }
+    }
+}
+
+inline void EpochSHPP::tryAdvance(){
+    unsigned epoch = globalEpoch.load();
+    int count = recordCount.load();
+    for (int i = 0; i < count; i++){
+        if (records[i].active.load() && records[i].epoch.load() != epoch){
+            return;
+        }
+    }
+    globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+inline void EpochSHPP::freeLimbo(Limbo& limbo){
+    for (int i = 0; i < limbo.objects.size(); i++){
+        limbo.objects[i].destroy(limbo.objects[i].object);
+    }
+    limbo.objects.clear();
+}
+
+#endif // EPOCHSHPP_H
@@ -0,0 +1,551 @@
+/* File: hashmapshpp.h
+ * --------------------------------------------------
+ * This interface exports a version of map based on
+ * a hash table with open addressing (Robin Hood hashing).
+ * It has the same interface as MapSHPP, but does not
+ * keep the keys in order.
+ */
+#ifndef HASHMAPSHPP_H
+#define HASHMAPSHPP_H
+
+#include <iostream>
+#include <stdlib.h>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "serializeshpp.h"
+
+
+/* Class: HashMapSHPP
+ * -------------------------------------------------
+ * This class implements map of a specified ValueType
+ * elements. Entries are stored in one flat array of slots,
+ * every slot keeps the distance of its entry from the home
+ * slot, so a lookup checks a short run of neighbouring slots
+ * and stops as soon as it meets a slot closer to its home.
+ * Keys need operator== and a hash function object.
+ */
+template<typename KeyType, typename ValueType, typename Hash = std::hash<KeyType> >
+class HashMapSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: HashMapSHPP
+     * Usage: HashMapSHPP<KeyType, ValueType> map;
+     *        HashMapSHPP<KeyType, ValueType, MyHash> map(MyHash(seed));
+     * -----------------------------------------------------
+     * Initializes a new empty map. Memory is not allocated
+     * until the first element is added
+     */
+    explicit HashMapSHPP(const Hash& hash = Hash());
+
+    /* Destructor: ~HashMapSHPP
+     * ----------------------------------------------
+     * Frees all allocated memory for the map elements
+     */
+    virtual ~HashMapSHPP();
+
+    /* Copy constructor*/
+    HashMapSHPP(const HashMapSHPP& src);
+
+    /* Operator: =
+     * mapNew = mapOld;
+     * -----------------------------------------------------
+     * Overloads assign operator
+     */
+    HashMapSHPP& operator=(const HashMapSHPP& src);
+
+    /* Method: put
+     * Usage: map.put(key, value);
+     * -----------------------------------------------
+     * Put the value in accordance with the key.
+     * If this key already exists then its value is replaced by a new
+     */
+    void put(const KeyType& key, const ValueType& value);
+    void put(const KeyType& key, ValueType&& value);
+    void put(KeyType&& key, ValueType&& value);
+
+    /* Method: emplace
+     * Usage: if (map.emplace(key, args...))...
+     * -----------------------------------------------
+     * Constructs the value from the received arguments right
+     * in the table if the key is absent. Returns true if
+     * the element was inserted, existing values stay unchanged
+     */
+    template<typename... Args>
+    bool emplace(const KeyType& key, Args&&... args);
+    template<typename... Args>
+    bool emplace(KeyType&& key, Args&&... args);
+
+    /* Method: get
+     * Usage: value = map.get(key);
+     * -----------------------------------------------
+     * Returns the value of the corresponding key
+     */
+    ValueType get(const KeyType& key);
+
+    /* Method: isEmpty
+     * Usage: if (map.isEmpty());
+     * -----------------------------------------------
+     * Returns true if map is empty
+     */
+    bool isEmpty();
+
+    /* Method: clear
+     * Usage: map.clear();
+     * ---------------------------------------------
+     * Removes all elements of the map. The table keeps
+     * its capacity
+     */
+    void clear();
+
+    /* Method: size
+     * Usage: int size = map.size();
+     * --------------------------------------------
+     * Return current number of the elements of the
+     * map
+     */
+    int size();
+
+    /* Method: reserve
+     * Usage: map.reserve(n);
+     * --------------------------------------------
+     * Grows the table so that n elements fit in it
+     * without any further rehashing
+     */
+    void reserve(int n);
+
+    /* Method: remove
+     * Usage: map.remove(key);
+     * -----------------------------------------------------
+     * Removes value of the map corresponding to the key
+     */
+    void remove(const KeyType& key);
+
+    /* Method: containsKey
+     * Usage: if (map.containsKey(key))
+     * -----------------------------------------------------
+     * Return true if map contains input key
+     */
+    bool containsKey(const KeyType& key);
+
+    /* Operator: []
+     * Usage: map[key] = value;
+     * ---------------------------------------------------
+     * Returns link to value by the specfied key. If the key
+     * is absent inserts it with default value first
+     */
+    ValueType& operator[](const KeyType& key);
+
+    /* Method: save
+     * Usage: map.save(out);
+     * ---------------------------------------------------
+     * Writes all pairs of key and value to the binary stream
+     */
+    void save(std::ostream& out) const;
+
+    /* Method: load
+     * Usage: map.load(in);
+     * ---------------------------------------------------
+     * Replaces the content of the map by the pairs read from
+     * the binary stream written by save. The table is sized
+     * once before the pairs are put
+     */
+    void load(std::istream& in);
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Key-value pair stored in the table*/
+    struct Entry {
+        template<typename K, typename... Args>
+        Entry(K&& key, Args&&... args) : Key(std::forward<K>(key)), Value(std::forward<Args>(args)...) {}
+        KeyType Key;
+        ValueType Value;
+    };
+
+    /* One cell of the table. The entry is constructed in the raw
+     * storage only when distance is not EMPTY*/
+    struct Slot {
+        int distance;
+        typename std::aligned_storage<sizeof(Entry), alignof(Entry)>::type storage;
+
+        Entry* entry(){
+            return reinterpret_cast<Entry*>(&storage);
+        }
+    };
+
+    /* Distance value of the free slot*/
+    static const int EMPTY = -1;
+
+    /* The smallest capacity of the allocated table*/
+    static const int START_SIZE = 8;
+
+    /* Table grows when it is filled more than this*/
+    static const int MAX_LOAD_PERCENT = 80;
+
+    /* Method: homeSlot
+     * -----------------------------------------------
+     * Returns the slot where probing for the key starts
+     */
+    int homeSlot(const KeyType& key);
+
+    /* Method: findSlot
+     * -----------------------------------------------
+     * Returns index of the slot with received key or
+     * -1 if such slot not found
+     */
+    int findSlot(const KeyType& key);
+
+    /* Method: insertEntry
+     * -----------------------------------------------
+     * Finds the entry with received key. If it is absent
+     * constructs new one from the key and args. Sets
+     * inserted to true only when the new entry was created
+     */
+    template<typename K, typename... Args>
+    Entry* insertEntry(K&& key, bool& inserted, Args&&... args);
+
+    /* Method: placeEntry
+     * -----------------------------------------------
+     * Constructs new entry for the key that is known to be
+     * absent. Shifts the richer entries of the cluster one
+     * slot forward to keep slots ordered by home position
+     */
+    template<typename K, typename... Args>
+    Entry* placeEntry(K&& key, Args&&... args);
+
+    /* Method: rehash
+     * -----------------------------------------------
+     * Moves all entries to the new table of received
+     * capacity
+     */
+    void rehash(int newCapacity);
+
+    /* Method: destroyEntries
+     * -----------------------------------------------
+     * Destroys all entries and marks all slots as free
+     */
+    void destroyEntries();
+
+    /* Method: deepCopy
+     * -----------------------------------------------
+     * Copies received HashMapSHPP to "this" HashMapSHPP
+     */
+    void deepCopy(const HashMapSHPP& src);
+
+    /* Array of the slots*/
+    Slot* slots;
+
+    /* Number of the slots, always power of two or 0*/
+    int capacity;
+
+    /* Right shift that turns mixed hash into slot index*/
+    int shift;
+
+    /* Current number of the elements in map*/
+    int count;
+
+    /* Hash function object*/
+    Hash hasher;
+};
+
+
+template<typename KeyType, typename ValueType, typename Hash>
+HashMapSHPP<KeyType, ValueType, Hash>::HashMapSHPP(const Hash& hash) : hasher(hash){
+    slots = 0;
+    capacity = 0;
+    shift = 64;
+    count = 0;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+HashMapSHPP<KeyType, ValueType, Hash>::~HashMapSHPP(){
+    destroyEntries();
+    delete[] slots;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+HashMapSHPP<KeyType, ValueType, Hash>::HashMapSHPP(const HashMapSHPP& src) : hasher(src.hasher){
+    deepCopy(src);
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+HashMapSHPP<KeyType, ValueType, Hash>& HashMapSHPP<KeyType, ValueType, Hash>::operator =(const HashMapSHPP& src){
+    if (this != &src){
+        destroyEntries();
+        delete[] slots;
+        hasher = src.hasher;
+        deepCopy(src);
+    }
+    return *this;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::deepCopy(const HashMapSHPP& src){
+    capacity = src.capacity;
+    shift = src.shift;
+    count = src.count;
+    slots = 0;
+    if (capacity > 0){
+        slots = new Slot[capacity];
+    }
+    for (int i = 0; i < capacity; i++){
+        slots[i].distance = src.slots[i].distance;
+        if (slots[i].distance != EMPTY){
+            Entry* entry = src.slots[i].entry();
+            new (&slots[i].storage) Entry(entry->Key, entry->Value);
+        }
+    }
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+int HashMapSHPP<KeyType, ValueType, Hash>::homeSlot(const KeyType& key){
+    /* Fibonacci hashing spreads weak hashes such as identity of ints*/
+    unsigned long long mixed = (unsigned long long)hasher(key) * 11400714819323198485ull;
+    return (int)(mixed >> shift);
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+int HashMapSHPP<KeyType, ValueType, Hash>::findSlot(const KeyType& key){
+    if (count == 0){
+        return -1;
+    }
+    int mask = capacity - 1;
+    int index = homeSlot(key);
+    for (int distance = 0; slots[index].distance >= distance; distance++){
+        if (slots[index].distance == distance && slots[index].entry()->Key == key){
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    return -1;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+template<typename K, typename... Args>
+typename HashMapSHPP<KeyType, ValueType, Hash>::Entry* HashMapSHPP<KeyType, ValueType, Hash>::insertEntry(K&& key, bool& inserted, Args&&... args){
+    int index = findSlot(key);
+    if (index >= 0){
+        inserted = false;
+        return slots[index].entry();
+    }
+    if ((long long)(count + 1) * 100 > (long long)capacity * MAX_LOAD_PERCENT){
+        rehash(capacity == 0 ? START_SIZE : capacity * 2);
+    }
+    inserted = true;
+    count++;
+    return placeEntry(std::forward<K>(key), std::forward<Args>(args)...);
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+template<typename K, typename... Args>
+typename HashMapSHPP<KeyType, ValueType, Hash>::Entry* HashMapSHPP<KeyType, ValueType, Hash>::placeEntry(K&& key, Args&&... args){
+    int mask = capacity - 1;
+    int index = homeSlot(key);
+    int distance = 0;
+    while (slots[index].distance >= distance){
+        index = (index + 1) & mask;
+        distance++;
+    }
+
+    /* Find the end of the cluster and shift its tail forward*/
+    int last = index;
+    while (slots[last].distance != EMPTY){
+        last = (last + 1) & mask;
+    }
+    while (last != index){
+        int previous = (last - 1) & mask;
+        Entry* entry = slots[previous].entry();
+        new (&slots[last].storage) Entry(std::move(*entry));
+        slots[last].distance = slots[previous].distance + 1;
+        entry->~Entry();
+        last = previous;
+    }
+
+    slots[index].distance = distance;
+    return new (&slots[index].storage) Entry(std::forward<K>(key), std::forward<Args>(args)...);
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::rehash(int newCapacity){
+    Slot* oldSlots = slots;
+    int oldCapacity = capacity;
+    slots = new Slot[newCapacity];
+    for (int i = 0; i < newCapacity; i++){
+        slots[i].distance = EMPTY;
+    }
+    capacity = newCapacity;
+    shift = 64;
+    while ((1 << (64 - shift)) < newCapacity){
+        shift--;
+    }
+
+    for (int i = 0; i < oldCapacity; i++){
+        if (oldSlots[i].distance != EMPTY){
+            Entry* entry = oldSlots[i].entry();
+            placeEntry(std::move(entry->Key), std::move(entry->Value));
+            entry->~Entry();
+        }
+    }
+    delete[] oldSlots;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::destroyEntries(){
+    for (int i = 0; i < capacity; i++){
+        if (slots[i].distance != EMPTY){
+            slots[i].entry()->~Entry();
+            slots[i].distance = EMPTY;
+        }
+    }
+    count = 0;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::put(const KeyType& key, const ValueType& value){
+    bool inserted;
+    Entry* entry = insertEntry(key, inserted, value);
+    if (!inserted){
+        entry->Value = value;
+    }
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::put(const KeyType& key, ValueType&& value){
+    bool inserted;
+    Entry* entry = insertEntry(key, inserted, std::move(value));
+    if (!inserted){
+        entry->Value = std::move(value);
+    }
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::put(KeyType&& key, ValueType&& value){
+    bool inserted;
+    Entry* entry = insertEntry(std::move(key), inserted, std::move(value));
+    if (!inserted){
+        entry->Value = std::move(value);
+    }
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+template<typename... Args>
+bool HashMapSHPP<KeyType, ValueType, Hash>::emplace(const KeyType& key, Args&&... args){
+    bool inserted;
+    insertEntry(key, inserted, std::forward<Args>(args)...);
+    return inserted;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+template<typename... Args>
+bool HashMapSHPP<KeyType, ValueType, Hash>::emplace(KeyType&& key, Args&&... args){
+    bool inserted;
+    insertEntry(std::move(key), inserted, std::forward<Args>(args)...);
+    return inserted;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+ValueType HashMapSHPP<KeyType, ValueType, Hash>::get(const KeyType& key){
+    int index = findSlot(key);
+    if (index < 0){
+        std::cout << "Error: key is not found in the map" << std::endl;
+        exit(1);
+    }
+    return slots[index].entry()->Value;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+bool HashMapSHPP<KeyType, ValueType, Hash>::isEmpty(){
+    return count == 0;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::clear(){
+    destroyEntries();
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+int HashMapSHPP<KeyType, ValueType, Hash>::size(){
+    return count;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::reserve(int n){
+    int newCapacity = capacity == 0 ? START_SIZE : capacity;
+    while ((long long)n * 100 > (long long)newCapacity * MAX_LOAD_PERCENT){
+        newCapacity *= 2;
+    }
+    if (newCapacity > capacity){
+        rehash(newCapacity);
+    }
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::remove(const KeyType& key){
+    if (count == 0){
+        std::cout << "Error: Map is empty" << std::endl;
+        exit(1);
+    }
+    int index = findSlot(key);
+    if (index < 0){
+        return;
+    }
+    slots[index].entry()->~Entry();
+    count--;
+
+    /* Backward shift keeps the cluster without holes*/
+    int mask = capacity - 1;
+    int next = (index + 1) & mask;
+    while (slots[next].distance > 0){
+        Entry* entry = slots[next].entry();
+        new (&slots[index].storage) Entry(std::move(*entry));
+        slots[index].distance = slots[next].distance - 1;
+        entry->~Entry();
+        index = next;
+        next = (next + 1) & mask;
+    }
+    slots[index].distance = EMPTY;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+bool HashMapSHPP<KeyType, ValueType, Hash>::containsKey(const KeyType& key){
+    return findSlot(key) >= 0;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+ValueType& HashMapSHPP<KeyType, ValueType, Hash>::operator [](const KeyType& key){
+    bool inserted;
+    return insertEntry(key, inserted)->Value;
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::save(std::ostream& out) const{
+    SerializeSHPP::writeHeader(out, SerializeSHPP::HASH_MAP, sizeof(KeyType), sizeof(ValueType), count);
+    for (int i = 0; i < capacity; i++){
+        if (slots[i].distance != EMPTY){
+            const Entry* entry = reinterpret_cast<const Entry*>(&slots[i].storage);
+            SerializerSHPP<KeyType>::write(out, entry->Key);
+            SerializerSHPP<ValueType>::write(out, entry->Value);
+        }
+    }
+}
+
+template<typename KeyType, typename ValueType, typename Hash>
+void HashMapSHPP<KeyType, ValueType, Hash>::load(std::istream& in){
+    int n = SerializeSHPP::readHeader(in, SerializeSHPP::HASH_MAP, sizeof(KeyType), sizeof(ValueType));
+    clear();
+    reserve(n);
+    for (int i = 0; i < n; i++){
+        KeyType key;
+        ValueType value;
+        SerializerSHPP<KeyType>::read(in, key);
+        SerializerSHPP<ValueType>::read(in, value);
+        SerializeSHPP::checkStream(in);
+        put(std::move(key), std::move(value));
+    }
+}
+
+#endif // HASHMAPSHPP_H
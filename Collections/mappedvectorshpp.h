@@ -0,0 +1,424 @@
+/* File: mappedvectorshpp.h
+ * -----------------------------------
+ *
+ * This file exports a vector which elements
+ * live in a memory mapped file. Needs POSIX
+ * (mmap, ftruncate, madvise).
+ */
+
+#ifndef MAPPEDVECTORSHPP_H
+#define MAPPEDVECTORSHPP_H
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkshpp.h"
+#include "spanshpp.h"
+
+/* Class MappedVectorSHPP<ValueType>
+ * --------------------------------
+ * This class implements a vector of trivially copyable elements
+ * stored in a file. The file is mapped to memory, so elements are
+ * read and written as in a usual array and the operating system
+ * loads and saves pages when they are needed. The number of
+ * elements is kept in the header of the file, so opening an
+ * existing file reads nothing. The file is bound to the element
+ * type: it records sizeof(ValueType) and may be opened only on the
+ * machine with the same byte order.
+ */
+template<typename ValueType>
+class MappedVectorSHPP{
+
+    static_assert(std::is_trivially_copyable<ValueType>::value,
+                  "MappedVectorSHPP needs trivially copyable elements");
+
+    /* Public methods prototypes*/
+public:
+
+    /* Type: AccessPattern
+     * -----------------------------------------------------
+     * Hints for the operating system how elements will be read
+     */
+    enum AccessPattern {
+        NORMAL,
+        SEQUENTIAL,
+        RANDOM,
+        WILL_NEED
+    };
+
+    /* Constructor: MappedVectorSHPP
+     * Usage: MappedVectorSHPP<ValueType> vector("data.bin");
+     * -----------------------------------------------------
+     * Opens the vector stored in the file, or creates a new empty
+     * vector if the file does not exist
+     */
+    explicit MappedVectorSHPP(const char *path);
+
+    /* Destructor: ~MappedVectorSHPP
+     * -----------------------------------------------------
+     * Unmaps the file, all elements stay in it
+     */
+    virtual ~MappedVectorSHPP();
+
+    /* Method: add
+     * Usage: vector.add(value);
+     * -----------------------------------------------------
+     * Add the specified value in the vector, grows the file
+     * if needed
+     */
+    void add(const ValueType& value);
+
+    /* Method: get
+     * Usage: value = vector.get(index);
+     * -----------------------------------------------------
+     * Returns value corresponding to the index in this vector
+     */
+    ValueType get(int index) const;
+
+    /* Method: set
+     * Usage: vector.set(index, value);
+     * -----------------------------------------------------
+     * Replaces the value at the specified index
+     */
+    void set(int index, const ValueType& value);
+
+    /* Method: size
+     * Usage: int size = vector.size();
+     * -----------------------------------------------------
+     * Returns the number of elements of this vector
+     */
+    int size() const;
+
+    /* Method: isEmpty
+     * Usage: if (vector.isEmpty())
+     * -----------------------------------------------------
+     * Returns true if this vector is empty
+     */
+    bool isEmpty() const;
+
+    /* Method: capacity
+     * Usage: int capacity = vector.capacity();
+     * -----------------------------------------------------
+     * Returns the number of elements the file can hold
+     * without growing
+     */
+    int capacity() const;
+
+    /* Method: reserve
+     * Usage: vector.reserve(n);
+     * -----------------------------------------------------
+     * Grows the file so it can hold at least n elements
+     */
+    void reserve(int n);
+
+    /* Method: clear
+     * Usage: vector.clear();
+     * -----------------------------------------------------
+     * Removes all elements, the file keeps its size
+     */
+    void clear();
+
+    /* Method: advise
+     * Usage: vector.advise(MappedVectorSHPP<ValueType>::SEQUENTIAL);
+     * -----------------------------------------------------
+     * Tells the operating system how elements will be read,
+     * so it can read pages ahead or stop doing it
+     */
+    void advise(AccessPattern pattern);
+
+    /* Method: sync
+     * Usage: vector.sync();
+     * -----------------------------------------------------
+     * Writes changed pages to the file and waits for it
+     */
+    void sync();
+
+    /* Method: data, begin, end
+     * Usage: std::sort(vector.begin(), vector.end());
+     * -----------------------------------------------------
+     * Return pointers to the mapped elements. They stay valid
+     * until the file grows
+     */
+    ValueType *data();
+    const ValueType *data() const;
+    ValueType *begin();
+    const ValueType *begin() const;
+    ValueType *end();
+    const ValueType *end() const;
+
+    /* Method: view
+     * Usage: SpanSHPP<ValueType> span = vector.view();
+     * -----------------------------------------------------
+     * Returns view of all elements of this vector
+     */
+    SpanSHPP<ValueType> view();
+    SpanSHPP<const ValueType> view() const;
+
+    /* Operator: []
+     * Usage: vector[index]
+     * -----------------------------------------------------
+     * Overloads [] to select elements from this vector.
+     */
+    const ValueType & operator[](int index) const;
+    ValueType & operator[](int index);
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Header at the beginning of the file. Its size keeps the
+     * elements aligned*/
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t elementSize;
+        int64_t count;
+        char reserved[40];
+    };
+
+    static_assert(sizeof(Header) == 64, "MappedVectorSHPP header must be 64 bytes");
+    static_assert(alignof(ValueType) <= sizeof(Header), "MappedVectorSHPP can not align elements");
+
+    /* Version of the file format*/
+    static const uint32_t VERSION = 1;
+
+    /* Size of the file created for a new vector*/
+    static const long START_BYTES = 4096;
+
+    /* Forbid copying, the vector owns the mapping*/
+    MappedVectorSHPP(const MappedVectorSHPP& src);
+    MappedVectorSHPP& operator=(const MappedVectorSHPP& src);
+
+    /* Method: mapFile
+     * Usage: mapFile(bytes);
+     * ------------------------------------------------
+     * Changes the size of the file to bytes and maps it again
+     */
+    void mapFile(long bytes);
+
+    /* Method: elements
+     * Usage: ValueType *array = elements();
+     * ------------------------------------------------
+     * Returns pointer to the first element after the header
+     */
+    ValueType *elements() const;
+
+    /* Descriptor of the open file*/
+    int file;
+
+    /* Mapped memory of the whole file*/
+    Header *header;
+
+    /* Size of the file in bytes*/
+    long fileBytes;
+
+    /* Number of elements the file can hold*/
+    int currentSize;
+};
+
+/* Implementation of all methods of MappedVectorSHPP class*/
+
+template<typename ValueType>
+MappedVectorSHPP<ValueType>::MappedVectorSHPP(const char *path){
+    header = 0;
+    fileBytes = 0;
+    file = open(path, O_RDWR | O_CREAT, 0644);
+    if (file < 0){
+        std::cout << "Error: can not open file " << path << std::endl;
+        exit(1);
+    }
+    struct stat info;
+    if (fstat(file, &info) != 0){
+        std::cout << "Error: can not read file " << path << std::endl;
+        exit(1);
+    }
+    if (info.st_size == 0){
+        /* New file: write the header of the empty vector*/
+        mapFile(START_BYTES);
+        memset(static_cast<void*>(header), 0, sizeof(Header));
+        memcpy(header->magic, "SHPPMVEC", 8);
+        header->version = VERSION;
+        header->elementSize = sizeof(ValueType);
+        header->count = 0;
+        return;
+    }
+    if (info.st_size < (off_t)sizeof(Header)){
+        std::cout << "Error: file " << path << " is not a MappedVectorSHPP" << std::endl;
+        exit(1);
+    }
+    mapFile(info.st_size);
+    if (memcmp(header->magic, "SHPPMVEC", 8) != 0 || header->version != VERSION){
+        std::cout << "Error: file " << path << " is not a MappedVectorSHPP" << std::endl;
+        exit(1);
+    }
+    if (header->elementSize != sizeof(ValueType) || header->count < 0 || header->count > currentSize){
+        std::cout << "Error: file " << path << " holds elements of another type" << std::endl;
+        exit(1);
+    }
+}
+
+template<typename ValueType>
+MappedVectorSHPP<ValueType>::~MappedVectorSHPP(){
+    munmap(header, fileBytes);
+    close(file);
+}
+
+template<typename ValueType>
+void MappedVectorSHPP<ValueType>::mapFile(long bytes){
+    if (header != 0){
+        munmap(header, fileBytes);
+        header = 0;
+    }
+    if (bytes != fileBytes && ftruncate(file, bytes) != 0){
+        std::cout << "Error: can not resize the file" << std::endl;
+        exit(1);
+    }
+    void *memory = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (memory == MAP_FAILED){
+        std::cout << "Error: can not map the file" << std::endl;
+        exit(1);
+    }
+    header = static_cast<Header*>(memory);
+    fileBytes = bytes;
+    long elementsCount = (bytes - (long)sizeof(Header)) / (long)sizeof(ValueType);
+    currentSize = elementsCount > 0x7fffffffL ? 0x7fffffff : (int)elementsCount;
+}
+
+template<typename ValueType>
+ValueType *MappedVectorSHPP<ValueType>::elements() const{
+    return reinterpret_cast<ValueType*>(header + 1);
+}
+
+template<typename ValueType>
+void MappedVectorSHPP<ValueType>::add(const ValueType& value){
+    int count = (int)header->count;
+    if (count == currentSize){
+        /* value may live in the mapping, keep a copy over remapping*/
+        ValueType copy = value;
+        if (count == 0x7fffffff){
+            std::cout << "Error: mapped vector is full" << std::endl;
+            exit(1);
+        }
+        long newSize = count < 1 ? 1 : (long)count * 2;
+        reserve(newSize > 0x7fffffffL ? 0x7fffffff : (int)newSize);
+        elements()[count] = copy;
+    } else {
+        elements()[count] = value;
+    }
+    header->count = count + 1;
+}
+
+template<typename ValueType>
+ValueType MappedVectorSHPP<ValueType>::get(int index) const{
+    SHPP_REQUIRE(index >= 0 && index < header->count, "Fatal error: index is not valid");
+    return elements()[index];
+}
+
+template<typename ValueType>
+void MappedVectorSHPP<ValueType>::set(int index, const ValueType& value){
+    SHPP_REQUIRE(index >= 0 && index < header->count, "Fatal error: index is not valid");
+    elements()[index] = value;
+}
+
+template<typename ValueType>
+int MappedVectorSHPP<ValueType>::size() const{
+    return (int)header->count;
+}
+
+template<typename ValueType>
+bool MappedVectorSHPP<ValueType>::isEmpty() const{
+    return header->count == 0;
+}
+
+template<typename ValueType>
+int MappedVectorSHPP<ValueType>::capacity() const{
+    return currentSize;
+}
+
+template<typename ValueType>
+void MappedVectorSHPP<ValueType>::reserve(int n){
+    if (n > currentSize){
+        mapFile((long)sizeof(Header) + (long)n * (long)sizeof(ValueType));
+    }
+}
+
+template<typename ValueType>
+void MappedVectorSHPP<ValueType>::clear(){
+    header->count = 0;
+}
+
+template<typename ValueType>
+void MappedVectorSHPP<ValueType>::advise(AccessPattern pattern){
+    int advice = MADV_NORMAL;
+    switch (pattern){
+    case SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+    case RANDOM: advice = MADV_RANDOM; break;
+    case WILL_NEED: advice = MADV_WILLNEED; break;
+    default: break;
+    }
+    madvise(header, fileBytes, advice);
+}
+
+template<typename ValueType>
+void MappedVectorSHPP<ValueType>::sync(){
+    msync(header, fileBytes, MS_SYNC);
+}
+
+template<typename ValueType>
+ValueType *MappedVectorSHPP<ValueType>::data(){
+    return elements();
+}
+
+template<typename ValueType>
+const ValueType *MappedVectorSHPP<ValueType>::data() const{
+    return elements();
+}
+
+template<typename ValueType>
+ValueType *MappedVectorSHPP<ValueType>::begin(){
+    return elements();
+}
+
+template<typename ValueType>
+const ValueType *MappedVectorSHPP<ValueType>::begin() const{
+    return elements();
+}
+
+template<typename ValueType>
+ValueType *MappedVectorSHPP<ValueType>::end(){
+    return elements() + header->count;
+}
+
+template<typename ValueType>
+const ValueType *MappedVectorSHPP<ValueType>::end() const{
+    return elements() + header->count;
+}
+
+template<typename ValueType>
+SpanSHPP<ValueType> MappedVectorSHPP<ValueType>::view(){
+    return SpanSHPP<ValueType>(elements(), (int)header->count);
+}
+
+template<typename ValueType>
+SpanSHPP<const ValueType> MappedVectorSHPP<ValueType>::view() const{
+    return SpanSHPP<const ValueType>(elements(), (int)header->count);
+}
+
+template<typename ValueType>
+const ValueType & MappedVectorSHPP<ValueType>::operator[](int index) const{
+    SHPP_REQUIRE(index >= 0 && index < header->count, "Fatal error: index is not valid");
+    return elements()[index];
+}
+
+template<typename ValueType>
+ValueType & MappedVectorSHPP<ValueType>::operator[](int index){
+    SHPP_REQUIRE(index >= 0 && index < header->count, "Fatal error: index is not valid");
+    return elements()[index];
+}
+
+#endif // MAPPEDVECTORSHPP_H
@@ -7,6 +7,10 @@
 #define MAPSHPP
 
 #include <iostream>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "serializeshpp.h"
 
 
 /* Class: MapSHPP
@@ -34,20 +38,91 @@ public:
     */
     virtual ~MapSHPP();
 
+    /* Copy constructor*/
+    MapSHPP(const MapSHPP<KeyType, ValueType>& src);
+
+    /* Move constructor, takes the nodes of src and leaves it empty*/
+    MapSHPP(MapSHPP<KeyType, ValueType>&& src);
+
+    /* Operator: =
+     * mapNew = mapOld;
+     * -----------------------------------------------------
+     * Overloads assign operator
+     */
+    MapSHPP<KeyType, ValueType>& operator=(const MapSHPP<KeyType, ValueType>& src);
+
+    /* Operator: =
+     * mapNew = std::move(mapOld);
+     * -----------------------------------------------------
+     * Takes the nodes of src and leaves it empty
+     */
+    MapSHPP<KeyType, ValueType>& operator=(MapSHPP<KeyType, ValueType>&& src);
+
     /* Method: put
      * Usage: map.put(key, value);
      * -----------------------------------------------
      * Put the value in accordance with the key.
      * If this key already exists then its value is replaced by a new
      */
-    void put(KeyType, ValueType);
+    void put(const KeyType& key, const ValueType& value);
+    void put(const KeyType& key, ValueType&& value);
+    void put(KeyType&& key, ValueType&& value);
+
+    /* Method: emplace
+     * Usage: if (map.emplace(key, args...))...
+     * -----------------------------------------------
+     * Constructs the value from the received arguments right
+     * in the new node if the key is absent. Returns true if
+     * the element was inserted, existing values stay unchanged
+     */
+    template<typename... Args>
+    bool emplace(const KeyType& key, Args&&... args);
+    template<typename... Args>
+    bool emplace(KeyType&& key, Args&&... args);
+
+    /* Method: tryEmplace
+     * Usage: std::pair<ValueType&, bool> result = map.tryEmplace(key, args...);
+     * -----------------------------------------------
+     * Same as emplace, but also returns link to the value
+     * stored for the key, new or existing one
+     */
+    template<typename... Args>
+    std::pair<ValueType&, bool> tryEmplace(const KeyType& key, Args&&... args);
+    template<typename... Args>
+    std::pair<ValueType&, bool> tryEmplace(KeyType&& key, Args&&... args);
+
+    /* Method: getOrDefault
+     * Usage: value = map.getOrDefault(key, defaultValue);
+     * -----------------------------------------------
+     * Returns the value of the corresponding key or the
+     * received default value if the key is absent
+     */
+    ValueType getOrDefault(const KeyType& key, const ValueType& defaultValue);
+
+    /* Method: computeIfPresent
+     * Usage: map.computeIfPresent(key, [](ValueType& value) { value++; });
+     * -----------------------------------------------
+     * Calls update with link to the value of the key if the key
+     * is present. Returns true if update was called
+     */
+    template<typename Update>
+    bool computeIfPresent(const KeyType& key, Update update);
+
+    /* Method: merge
+     * Usage: map.merge(key, 1, [](const ValueType& old, const ValueType& value) { return old + value; });
+     * -----------------------------------------------
+     * Puts the value if the key is absent, otherwise replaces
+     * the stored value by combine(stored, value)
+     */
+    template<typename Combine>
+    void merge(const KeyType& key, const ValueType& value, Combine combine);
 
     /* Method: get
      * Usage: value = map.get(key);
      * -----------------------------------------------
      * Returns the value of the corresponding key
      */
-    ValueType get(KeyType key);
+    ValueType get(const KeyType& key);
 
     /* Method: isEmpty
      * Usage: if (map.isEmpty());
@@ -76,34 +151,235 @@ public:
      * -----------------------------------------------------
      * Removes value of the map corresponding to the key
      */
-    void remove(KeyType);
+    void remove(const KeyType& key);
 
     /* Method: containsKey
      * Usage: if (map.containsKey(key))
      * -----------------------------------------------------
      * Return true if map contains input key
      */
-    bool containsKey(KeyType key);
+    bool containsKey(const KeyType& key);
 
     /* Operator: []
      * Usage: map[key] = value;
      * ---------------------------------------------------
-     * Returns link to value by the specfied key.
+     * Returns link to value by the specfied key. If the key
+     * is absent inserts it with default value first
+     */
+    ValueType& operator[](const KeyType& key);
+
+    /* Method: buildFromSorted
+     * Usage: map.buildFromSorted(keys, values, n);
+     * ---------------------------------------------------
+     * Replaces the content of the map by n elements taken from
+     * the received key and value sequences. Keys must go in
+     * strictly ascending order. Builds perfectly balanced tree
+     * in O(n) without any rotations
      */
-    ValueType& operator[](KeyType);
+    template<typename KeyIterator, typename ValueIterator>
+    void buildFromSorted(KeyIterator keys, ValueIterator values, int n);
+
+    /* Method: buildFromSorted
+     * Usage: map.buildFromSorted(pairs.begin(), pairs.end());
+     * ---------------------------------------------------
+     * Same as above for a range of elements with first (key)
+     * and second (value) fields, for example std::pair
+     */
+    template<typename PairIterator>
+    void buildFromSorted(PairIterator first, PairIterator last);
+
+    /* Method: save
+     * Usage: map.save(out);
+     * ---------------------------------------------------
+     * Writes all pairs of key and value to the binary stream
+     * in ascending order of the keys
+     */
+    void save(std::ostream& out) const;
+
+    /* Method: load
+     * Usage: map.load(in);
+     * ---------------------------------------------------
+     * Replaces the content of the map by the pairs read from
+     * the binary stream written by save. Keys are already
+     * sorted, so the tree is built in O(n) as in buildFromSorted
+     */
+    void load(std::istream& in);
+
+    class iterator;
+
+    /* Method: begin
+     * Usage: for (MapSHPP<KeyType, ValueType>::iterator it = map.begin(); it != map.end(); ++it)
+     * -----------------------------------------------------
+     * Returns iterator to the element with the smallest key
+     */
+    iterator begin();
+
+    /* Method: end
+     * Usage: it != map.end()
+     * -----------------------------------------------------
+     * Returns iterator that points past the element with
+     * the largest key
+     */
+    iterator end();
+
+    /* Method: lowerBound
+     * Usage: iterator it = map.lowerBound(key);
+     * -----------------------------------------------------
+     * Returns iterator to the first element whose key is not
+     * less than the received key
+     */
+    iterator lowerBound(const KeyType& key);
+
+    /* Method: upperBound
+     * Usage: iterator it = map.upperBound(key);
+     * -----------------------------------------------------
+     * Returns iterator to the first element whose key is
+     * greater than the received key
+     */
+    iterator upperBound(const KeyType& key);
+
+    class Range;
+
+    /* Method: range
+     * Usage: for (auto it : map.range(lo, hi))...
+     * -----------------------------------------------------
+     * Returns the elements whose keys lie in [lo, hi) in
+     * ascending order. Costs O(log n) to position plus O(1)
+     * amortized per visited element
+     */
+    Range range(const KeyType& lo, const KeyType& hi);
+
+    /* Method: rank
+     * Usage: int position = map.rank(key);
+     * -----------------------------------------------------
+     * Returns the number of the keys that are less than the
+     * received key in O(log n)
+     */
+    int rank(const KeyType& key);
+
+    /* Method: select
+     * Usage: KeyType median = map.select(map.size() / 2);
+     * -----------------------------------------------------
+     * Returns the k-th smallest key, counting from 0, in
+     * O(log n)
+     */
+    const KeyType& select(int k);
+
+    /* Method: countInRange
+     * Usage: int n = map.countInRange(lo, hi);
+     * -----------------------------------------------------
+     * Returns the number of the keys in [lo, hi) in O(log n)
+     */
+    int countInRange(const KeyType& lo, const KeyType& hi);
 
     /* Private methods prototypes and instase variables*/
 private:
 
     /* Structure for storing key-value pairs and build BST*/
     struct BSTNode {
+        template<typename K, typename... Args>
+        BSTNode(K&& key, Args&&... args) : Key(std::forward<K>(key)), Value(std::forward<Args>(args)...) {}
         KeyType Key;
         ValueType Value;
         int length;
+        int weight;
         BSTNode* left;
         BSTNode* right;
+        BSTNode* parent;
+    };
+
+    /* Upper limit of the AVL tree height, enough for any int count*/
+    static const int MAX_HEIGHT = 64;
+
+public:
+
+    /* Class: iterator
+     * -------------------------------------------------
+     * In-order iterator over the map. Keeps only the current
+     * node and moves to the next one through child and parent
+     * links, so it is as cheap to copy as a pointer and walking
+     * the whole map costs O(n).
+     * Iterators are invalidated by put and remove.
+     */
+    class iterator {
+    public:
+
+        /* Constructor: iterator
+         * Usage: MapSHPP<KeyType, ValueType>::iterator it;
+         * -----------------------------------------------
+         * Initializes an iterator equal to end()
+         */
+        iterator();
+
+        /* Method: key
+         * Usage: KeyType key = it.key();
+         * -----------------------------------------------
+         * Returns the key of the current element
+         */
+        const KeyType& key() const;
+
+        /* Method: value
+         * Usage: it.value() = newValue;
+         * -----------------------------------------------
+         * Returns link to the value of the current element
+         */
+        ValueType& value() const;
+
+        /* Operator: *
+         * Usage: KeyType key = *it;
+         * -----------------------------------------------
+         * Returns the key of the current element
+         */
+        const KeyType& operator*() const;
+
+        /* Operator: ++
+         * Usage: ++it;
+         * -----------------------------------------------
+         * Moves iterator to the element with the next key
+         */
+        iterator& operator++();
+
+        /* Operator: ++
+         * Usage: it++;
+         * -----------------------------------------------
+         * Moves iterator to the element with the next key and
+         * returns its previous state
+         */
+        iterator operator++(int);
+
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+
+    private:
+        friend class MapSHPP;
+
+        iterator(BSTNode* node);
+
+        /* Returns the node with the smallest key of the sub-tree*/
+        static BSTNode* leftmost(BSTNode* node);
+
+        /* Current node or 0 for end()*/
+        BSTNode* node;
+    };
+
+    /* Class: Range
+     * -------------------------------------------------
+     * Pair of iterators returned by range(), usable in
+     * range-based for loops
+     */
+    class Range {
+    public:
+        Range(const iterator& first, const iterator& last);
+        iterator begin() const;
+        iterator end() const;
+
+    private:
+        iterator first;
+        iterator last;
     };
 
+private:
+
     /*
      * Method: balanceTree
      * ---------------------------------------------------
@@ -117,6 +393,12 @@ private:
      */
     int getNodeHeight(BSTNode* node);
 
+    /* Method: getNodeWeight
+     * --------------------------------------------------
+     * Counts the number of the nodes in a binary tree
+     */
+    int getNodeWeight(BSTNode* node);
+
     /* Method: getBalanceFactor
      * -------------------------------------------------
      * Counts the difference in height between the
@@ -126,7 +408,9 @@ private:
 
     /* Method: fixHeight
      * ------------------------------------------------
-     * Recalculates the height of a given node
+     * Recalculates the height and the weight of a given node
+     * and links its children back to it. Every node whose
+     * children change passes here, so parent links stay valid
      */
     void fixHeight(BSTNode* node);
 
@@ -142,53 +426,117 @@ private:
      */
     BSTNode* rotateLeft(BSTNode* node);
 
-    /* Method: insertNode
+    /* Method: rebalancePath
      * -----------------------------------------------
-     * Inserts new node with received key and value to
-     * the tree and balance it after this
+     * Balances the nodes referenced by the received links
+     * from the deepest one up to the root
      */
-    BSTNode* insertNode(BSTNode* node, KeyType key, ValueType value);
+    void rebalancePath(BSTNode** path[], int depth);
 
-    /* Method: removeNode
+    /* Method: insertNode
      * -----------------------------------------------
-     * Removed node with received key and balance tree
-     * after this
+     * Finds the node with received key in one descent. If it
+     * is absent constructs new node from the key and args and
+     * balance the tree after this. Sets inserted to true only
+     * when the new node was created
      */
-    BSTNode* removeNode(BSTNode* node, KeyType key);
+    template<typename K, typename... Args>
+    BSTNode* insertNode(K&& key, bool& inserted, Args&&... args);
 
-    /* Method: findMinNode
+    /* Method: buildSubtree
      * -----------------------------------------------
-     * Returns pointer to the node with minimal key in
-     * the received sub-tree
+     * Builds balanced tree of n nodes created in ascending
+     * order by the received emitter and returns its root
      */
-    BSTNode* findMinNode(BSTNode* node);
+    template<typename Emitter>
+    BSTNode* buildSubtree(Emitter& emit, int n);
 
-    /* Method: removeMinNode
+    /* Method: removeNode
      * -----------------------------------------------
-     * Removes minimal element of the received sub-tree
-     * and balance it after this
+     * Removed node with received key and balance tree
+     * after this. Does nothing if key is absent
      */
-    BSTNode* removeMinNode(BSTNode* node);
+    void removeNode(const KeyType& key);
 
     /* Method: findNode
      * -----------------------------------------------
      * Returns pointer to the node that contains received
      * key or 0 if such node not found
      */
-    BSTNode* findNode(BSTNode* node, KeyType key);
+    BSTNode* findNode(const KeyType& key);
 
-    /* Method: clearBST
+    /* Method: clearTree
      * -----------------------------------------------
-     * Frees all memoty allocated for the nodes of
-     * the binaty tree
+     * Destroys keys and values of all nodes of the
+     * binary tree. Memory of the nodes stays in the slabs.
+     * Flattens the tree with rotations, so needs no stack
      */
     void clearTree(BSTNode* node);
 
+    /* Number of the nodes in one slab of the node pool*/
+    static const int SLAB_SIZE = 128;
+
+    /* Block of raw memory for SLAB_SIZE nodes, slabs are linked in a list*/
+    struct Slab {
+        Slab* next;
+        typename std::aligned_storage<sizeof(BSTNode), alignof(BSTNode)>::type nodes[SLAB_SIZE];
+    };
+
+    /* Released node memory, reused before taking new slab memory*/
+    struct FreeCell {
+        FreeCell* next;
+    };
+
+    /* Method: allocateNode
+     * -----------------------------------------------
+     * Constructs new node in memory taken from the free
+     * list or from the newest slab
+     */
+    template<typename K, typename... Args>
+    BSTNode* allocateNode(K&& key, Args&&... args);
+
+    /* Method: releaseNode
+     * -----------------------------------------------
+     * Destroys the node and returns its memory to the
+     * free list
+     */
+    void releaseNode(BSTNode* node);
+
+    /* Method: releaseAllNodes
+     * -----------------------------------------------
+     * Destroys all nodes of the tree and frees all slabs
+     */
+    void releaseAllNodes();
+
+    /* Method: deepCopy
+     * -----------------------------------------------
+     * Builds balanced copy of the tree of src in O(n) from
+     * the in-order walk, as buildFromSorted does. The map
+     * must be empty
+     */
+    void deepCopy(const MapSHPP<KeyType, ValueType>& src);
+
+    /* Method: takeNodes
+     * -----------------------------------------------
+     * Takes the tree and the slabs of src and leaves it
+     * empty. The map must be empty
+     */
+    void takeNodes(MapSHPP<KeyType, ValueType>& src);
+
     /* Current number of the elements in map*/
     int count;
 
     /* Contains link the top node*/
     BSTNode* mainNode;
+
+    /* List of the slabs, the head is the one being filled*/
+    Slab* slabs;
+
+    /* Number of the used nodes in the head slab*/
+    int slabUsed;
+
+    /* List of the released nodes*/
+    FreeCell* freeNodes;
 };
 
 
@@ -196,11 +544,120 @@ template<typename KeyType, typename ValueType>
 MapSHPP<KeyType, ValueType>::MapSHPP(){
     mainNode = 0;
     count = 0;
+    slabs = 0;
+    slabUsed = SLAB_SIZE;
+    freeNodes = 0;
 }
 
 template<typename KeyType, typename ValueType>
 MapSHPP<KeyType, ValueType>::~MapSHPP(){
-    clearTree(mainNode);
+    releaseAllNodes();
+}
+
+template<typename KeyType, typename ValueType>
+MapSHPP<KeyType, ValueType>::MapSHPP(const MapSHPP<KeyType, ValueType>& src){
+    mainNode = 0;
+    count = 0;
+    slabs = 0;
+    slabUsed = SLAB_SIZE;
+    freeNodes = 0;
+    deepCopy(src);
+}
+
+template<typename KeyType, typename ValueType>
+MapSHPP<KeyType, ValueType>::MapSHPP(MapSHPP<KeyType, ValueType>&& src){
+    takeNodes(src);
+}
+
+template<typename KeyType, typename ValueType>
+MapSHPP<KeyType, ValueType>& MapSHPP<KeyType, ValueType>::operator =(const MapSHPP<KeyType, ValueType>& src){
+    if (this != &src){
+        releaseAllNodes();
+        deepCopy(src);
+    }
+    return *this;
+}
+
+template<typename KeyType, typename ValueType>
+MapSHPP<KeyType, ValueType>& MapSHPP<KeyType, ValueType>::operator =(MapSHPP<KeyType, ValueType>&& src){
+    if (this != &src){
+        releaseAllNodes();
+        takeNodes(src);
+    }
+    return *this;
+}
+
+template<typename KeyType, typename ValueType>
+void MapSHPP<KeyType, ValueType>::deepCopy(const MapSHPP<KeyType, ValueType>& src){
+    iterator it(iterator::leftmost(src.mainNode));
+    auto emit = [&]() {
+        BSTNode* node = allocateNode(it.key(), it.value());
+        ++it;
+        return node;
+    };
+    mainNode = buildSubtree(emit, src.count);
+    if (mainNode != 0){
+        mainNode->parent = 0;
+    }
+    count = src.count;
+}
+
+template<typename KeyType, typename ValueType>
+void MapSHPP<KeyType, ValueType>::takeNodes(MapSHPP<KeyType, ValueType>& src){
+    mainNode = src.mainNode;
+    count = src.count;
+    slabs = src.slabs;
+    slabUsed = src.slabUsed;
+    freeNodes = src.freeNodes;
+    src.mainNode = 0;
+    src.count = 0;
+    src.slabs = 0;
+    src.slabUsed = SLAB_SIZE;
+    src.freeNodes = 0;
+}
+
+template<typename KeyType, typename ValueType>
+template<typename K, typename... Args>
+typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::allocateNode(K&& key, Args&&... args){
+    void* place;
+    if (freeNodes != 0){
+        place = freeNodes;
+        freeNodes = freeNodes->next;
+    } else {
+        if (slabUsed == SLAB_SIZE){
+            Slab* slab = new Slab;
+            slab->next = slabs;
+            slabs = slab;
+            slabUsed = 0;
+        }
+        place = &slabs->nodes[slabUsed];
+        slabUsed++;
+    }
+    return new (place) BSTNode(std::forward<K>(key), std::forward<Args>(args)...);
+}
+
+template<typename KeyType, typename ValueType>
+void MapSHPP<KeyType, ValueType>::releaseNode(BSTNode* node){
+    node->~BSTNode();
+    FreeCell* cell = reinterpret_cast<FreeCell*>(node);
+    cell->next = freeNodes;
+    freeNodes = cell;
+}
+
+template<typename KeyType, typename ValueType>
+void MapSHPP<KeyType, ValueType>::releaseAllNodes(){
+    if (!std::is_trivially_destructible<BSTNode>::value){
+        clearTree(mainNode);
+    }
+    while (slabs != 0){
+        Slab* tmp = slabs;
+        slabs = slabs->next;
+        delete tmp;
+    }
+    slabUsed = SLAB_SIZE;
+    freeNodes = 0;
+    mainNode = 0;
+    count = 0;
 }
 
 template<typename KeyType, typename ValueType>
@@ -216,6 +673,14 @@ int MapSHPP<KeyType, ValueType>::getBalanceFactor(BSTNode *node){
     return getNodeHeight(node->right) - getNodeHeight(node->left);
 }
 
+template<typename KeyType, typename ValueType>
+int MapSHPP<KeyType, ValueType>::getNodeWeight(BSTNode *node){
+    if (node != 0){
+        return node->weight;
+    }
+    return 0;
+}
+
 template<typename KeyType, typename ValueType>
 void MapSHPP<KeyType, ValueType>::fixHeight(BSTNode *node){
     if (getNodeHeight(node->left) > getNodeHeight(node->right)){
@@ -223,6 +688,13 @@ void MapSHPP<KeyType, ValueType>::fixHeight(BSTNode *node){
     } else {
         node->length = getNodeHeight(node->right) + 1;
     }
+    node->weight = getNodeWeight(node->left) + getNodeWeight(node->right) + 1;
+    if (node->left != 0){
+        node->left->parent = node;
+    }
+    if (node->right != 0){
+        node->right->parent = node;
+    }
 }
 
 template<typename KeyType, typename ValueType>
@@ -230,8 +702,8 @@ typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::rota
     BSTNode* newRoot = node->right;
     node->right = newRoot->left;
     newRoot->left = node;
-    fixHeight(newRoot);
     fixHeight(node);
+    fixHeight(newRoot);
     return newRoot;
 }
 
@@ -265,101 +737,331 @@ typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::bala
 }
 
 template<typename KeyType, typename ValueType>
-typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::insertNode(BSTNode* node, KeyType key, ValueType value){
-    if (node == 0){
-        node = new BSTNode;
-        node->Key = key;
-        node->Value = value;
-        node->length = 1;
-        node->right = 0;
-        node->left = 0;
-        count++;
+void MapSHPP<KeyType, ValueType>::rebalancePath(BSTNode** path[], int depth){
+    for (int i = depth - 1; i >= 0; i--){
+        *path[i] = balanceTree(*path[i]);
+    }
+}
+
+template<typename KeyType, typename ValueType>
+template<typename K, typename... Args>
+typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::insertNode(K&& key, bool& inserted, Args&&... args){
+    BSTNode** path[MAX_HEIGHT];
+    int depth = 0;
+    BSTNode** link = &mainNode;
+    while (*link != 0){
+        BSTNode* node = *link;
+        if (key < node->Key){
+            path[depth++] = link;
+            link = &node->left;
+        } else if (node->Key < key){
+            path[depth++] = link;
+            link = &node->right;
+        } else {
+            inserted = false;
+            return node;
+        }
+    }
+
+    BSTNode* node = allocateNode(std::forward<K>(key), std::forward<Args>(args)...);
+    node->length = 1;
+    node->weight = 1;
+    node->right = 0;
+    node->left = 0;
+    node->parent = 0;
+    *link = node;
+    count++;
+    inserted = true;
+    rebalancePath(path, depth);
+    mainNode->parent = 0;
+    return node;
+}
+
+template<typename KeyType, typename ValueType>
+template<typename Emitter>
+typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::buildSubtree(Emitter& emit, int n){
+    if (n == 0){
+        return 0;
+    }
+    int leftCount = n / 2;
+    BSTNode* leftNode = buildSubtree(emit, leftCount);
+    BSTNode* node = emit();
+    node->left = leftNode;
+    node->right = buildSubtree(emit, n - leftCount - 1);
+    fixHeight(node);
+    return node;
+}
+
+template<typename KeyType, typename ValueType>
+template<typename KeyIterator, typename ValueIterator>
+void MapSHPP<KeyType, ValueType>::buildFromSorted(KeyIterator keys, ValueIterator values, int n){
+    releaseAllNodes();
+    BSTNode* previous = 0;
+    auto emit = [&]() {
+        BSTNode* node = allocateNode(*keys, *values);
+        if (previous != 0 && !(previous->Key < node->Key)){
+            std::cout << "Error: keys are not sorted" << std::endl;
+            exit(1);
+        }
+        ++keys;
+        ++values;
+        previous = node;
         return node;
-    } else if (key > node->Key){
-        node->right = insertNode(node->right, key, value);
-    } else if (key < node->Key){
-        node->left = insertNode(node->left, key, value);
-    } else {
-        node->Value = value;
+    };
+    mainNode = buildSubtree(emit, n);
+    if (mainNode != 0){
+        mainNode->parent = 0;
     }
-    return balanceTree(node);
+    count = n;
 }
 
 template<typename KeyType, typename ValueType>
-typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::findNode(BSTNode* node, KeyType key){
-    if (key > node->Key){
-        if(node->right == 0){
-            return 0;
+template<typename PairIterator>
+void MapSHPP<KeyType, ValueType>::buildFromSorted(PairIterator first, PairIterator last){
+    int n = 0;
+    for (PairIterator it = first; it != last; ++it){
+        n++;
+    }
+    releaseAllNodes();
+    BSTNode* previous = 0;
+    auto emit = [&]() {
+        BSTNode* node = allocateNode(first->first, first->second);
+        if (previous != 0 && !(previous->Key < node->Key)){
+            std::cout << "Error: keys are not sorted" << std::endl;
+            exit(1);
         }
-        return findNode(node->right, key);
-    } else if (key < node->Key){
-        if (node->left == 0){
-            return 0;
+        ++first;
+        previous = node;
+        return node;
+    };
+    mainNode = buildSubtree(emit, n);
+    if (mainNode != 0){
+        mainNode->parent = 0;
+    }
+    count = n;
+}
+
+template<typename KeyType, typename ValueType>
+void MapSHPP<KeyType, ValueType>::save(std::ostream& out) const{
+    SerializeSHPP::writeHeader(out, SerializeSHPP::SORTED_MAP, sizeof(KeyType), sizeof(ValueType), count);
+    const BSTNode* path[MAX_HEIGHT];
+    int depth = 0;
+    const BSTNode* node = mainNode;
+    while (node != 0 || depth > 0){
+        while (node != 0){
+            path[depth++] = node;
+            node = node->left;
         }
-        return findNode(node->left, key);
+        node = path[--depth];
+        SerializerSHPP<KeyType>::write(out, node->Key);
+        SerializerSHPP<ValueType>::write(out, node->Value);
+        node = node->right;
     }
-    return node;
 }
 
 template<typename KeyType, typename ValueType>
-typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::removeNode(BSTNode* node, KeyType key){
-    if (key < node->Key){
-        node->left = removeNode(node->left, key);
-    } else if (key >node->Key){
-        node->right = removeNode(node->right, key);
-    } else if (key == node->Key){
-        BSTNode* leftNode = node->left;
-        BSTNode* rightNode = node->right;
-        delete node;
-        count--;
-        if (rightNode == 0){
-            return leftNode;
+void MapSHPP<KeyType, ValueType>::load(std::istream& in){
+    int n = SerializeSHPP::readHeader(in, SerializeSHPP::SORTED_MAP, sizeof(KeyType), sizeof(ValueType));
+    releaseAllNodes();
+    BSTNode* previous = 0;
+    auto emit = [&]() {
+        KeyType key;
+        ValueType value;
+        SerializerSHPP<KeyType>::read(in, key);
+        SerializerSHPP<ValueType>::read(in, value);
+        SerializeSHPP::checkStream(in);
+        BSTNode* node = allocateNode(std::move(key), std::move(value));
+        if (previous != 0 && !(previous->Key < node->Key)){
+            std::cout << "Error: keys are not sorted" << std::endl;
+            exit(1);
         }
-        BSTNode* minNode = findMinNode(rightNode);
-        minNode->right = removeMinNode(rightNode);
-        minNode->left = leftNode;
-        return balanceTree(minNode);
+        previous = node;
+        return node;
+    };
+    mainNode = buildSubtree(emit, n);
+    if (mainNode != 0){
+        mainNode->parent = 0;
     }
-    return balanceTree(node);
+    count = n;
 }
 
 template<typename KeyType, typename ValueType>
-typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::findMinNode(BSTNode *node){
-    if (node->left != 0){
-        return findMinNode(node->left);
+typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::findNode(const KeyType& key){
+    BSTNode* node = mainNode;
+    while (node != 0){
+        if (key < node->Key){
+            node = node->left;
+        } else if (node->Key < key){
+            node = node->right;
+        } else {
+            return node;
+        }
     }
-    return node;
+    return 0;
 }
 
 template<typename KeyType, typename ValueType>
-typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::removeMinNode(BSTNode *node){
-    if(node->left == 0){
-        return node->right;
+void MapSHPP<KeyType, ValueType>::removeNode(const KeyType& key){
+    BSTNode** path[MAX_HEIGHT];
+    int depth = 0;
+    BSTNode** link = &mainNode;
+    while (*link != 0){
+        BSTNode* node = *link;
+        if (key < node->Key){
+            path[depth++] = link;
+            link = &node->left;
+        } else if (node->Key < key){
+            path[depth++] = link;
+            link = &node->right;
+        } else {
+            break;
+        }
+    }
+    if (*link == 0){
+        return;
+    }
+
+    BSTNode* node = *link;
+    if (node->right == 0){
+        *link = node->left;
+    } else {
+        /* Replace the node by the minimal node of its right sub-tree*/
+        int nodeDepth = depth;
+        path[depth++] = link;
+        BSTNode** minLink = &node->right;
+        while ((*minLink)->left != 0){
+            path[depth++] = minLink;
+            minLink = &(*minLink)->left;
+        }
+        BSTNode* minNode = *minLink;
+        *minLink = minNode->right;
+        minNode->left = node->left;
+        minNode->right = node->right;
+        *link = minNode;
+        if (depth > nodeDepth + 1){
+            path[nodeDepth + 1] = &minNode->right;
+        }
+    }
+    releaseNode(node);
+    count--;
+    rebalancePath(path, depth);
+    if (mainNode != 0){
+        mainNode->parent = 0;
     }
-    node->left = removeMinNode(node->left);
-    return balanceTree(node);
 }
 
 template<typename KeyType, typename ValueType>
 void MapSHPP<KeyType, ValueType>::clearTree(BSTNode *node){
-    if (node->left != 0){
-        clearTree(node->left);
+    while (node != 0){
+        if (node->left != 0){
+            BSTNode* leftNode = node->left;
+            node->left = leftNode->right;
+            leftNode->right = node;
+            node = leftNode;
+        } else {
+            BSTNode* rightNode = node->right;
+            node->~BSTNode();
+            node = rightNode;
+        }
     }
-    if (node->right != 0){
-        clearTree(node->right);
+}
+
+template<typename KeyType, typename ValueType>
+void MapSHPP<KeyType, ValueType>::put(const KeyType& key, const ValueType& value){
+    bool inserted;
+    BSTNode* node = insertNode(key, inserted, value);
+    if (!inserted){
+        node->Value = value;
+    }
+}
+
+template<typename KeyType, typename ValueType>
+void MapSHPP<KeyType, ValueType>::put(const KeyType& key, ValueType&& value){
+    bool inserted;
+    BSTNode* node = insertNode(key, inserted, std::move(value));
+    if (!inserted){
+        node->Value = std::move(value);
+    }
+}
+
+template<typename KeyType, typename ValueType>
+void MapSHPP<KeyType, ValueType>::put(KeyType&& key, ValueType&& value){
+    bool inserted;
+    BSTNode* node = insertNode(std::move(key), inserted, std::move(value));
+    if (!inserted){
+        node->Value = std::move(value);
+    }
+}
+
+template<typename KeyType, typename ValueType>
+template<typename... Args>
+bool MapSHPP<KeyType, ValueType>::emplace(const KeyType& key, Args&&... args){
+    bool inserted;
+    insertNode(key, inserted, std::forward<Args>(args)...);
+    return inserted;
+}
+
+template<typename KeyType, typename ValueType>
+template<typename... Args>
+bool MapSHPP<KeyType, ValueType>::emplace(KeyType&& key, Args&&... args){
+    bool inserted;
+    insertNode(std::move(key), inserted, std::forward<Args>(args)...);
+    return inserted;
+}
+
+template<typename KeyType, typename ValueType>
+template<typename... Args>
+std::pair<ValueType&, bool> MapSHPP<KeyType, ValueType>::tryEmplace(const KeyType& key, Args&&... args){
+    bool inserted;
+    BSTNode* node = insertNode(key, inserted, std::forward<Args>(args)...);
+    return std::pair<ValueType&, bool>(node->Value, inserted);
+}
+
+template<typename KeyType, typename ValueType>
+template<typename... Args>
+std::pair<ValueType&, bool> MapSHPP<KeyType, ValueType>::tryEmplace(KeyType&& key, Args&&... args){
+    bool inserted;
+    BSTNode* node = insertNode(std::move(key), inserted, std::forward<Args>(args)...);
+    return std::pair<ValueType&, bool>(node->Value, inserted);
+}
+
+template<typename KeyType, typename ValueType>
+ValueType MapSHPP<KeyType, ValueType>::getOrDefault(const KeyType& key, const ValueType& defaultValue){
+    BSTNode* tmp = findNode(key);
+    if (tmp == 0){
+        return defaultValue;
     }
+    return tmp->Value;
+}
 
-    delete node;
+template<typename KeyType, typename ValueType>
+template<typename Update>
+bool MapSHPP<KeyType, ValueType>::computeIfPresent(const KeyType& key, Update update){
+    BSTNode* tmp = findNode(key);
+    if (tmp == 0){
+        return false;
+    }
+    update(tmp->Value);
+    return true;
 }
 
 template<typename KeyType, typename ValueType>
-void MapSHPP<KeyType, ValueType>::put(KeyType key, ValueType value){
-    mainNode = insertNode(mainNode, key, value);
+template<typename Combine>
+void MapSHPP<KeyType, ValueType>::merge(const KeyType& key, const ValueType& value, Combine combine){
+    bool inserted;
+    BSTNode* node = insertNode(key, inserted, value);
+    if (!inserted){
+        node->Value = combine(node->Value, value);
+    }
 }
 
 template<typename KeyType, typename ValueType>
-ValueType MapSHPP<KeyType, ValueType>::get(KeyType key){
-    BSTNode* tmp = findNode(mainNode, key);
+ValueType MapSHPP<KeyType, ValueType>::get(const KeyType& key){
+    BSTNode* tmp = findNode(key);
+    if (tmp == 0){
+        std::cout << "Error: key is not found in the map" << std::endl;
+        exit(1);
+    }
     return tmp->Value;
 }
 
@@ -369,9 +1071,9 @@ int MapSHPP<KeyType, ValueType>::size(){
 }
 
 template<typename KeyType, typename ValueType>
-void MapSHPP<KeyType, ValueType>::remove(KeyType key){
+void MapSHPP<KeyType, ValueType>::remove(const KeyType& key){
     if(count > 0){
-        mainNode = removeNode(mainNode, key);
+        removeNode(key);
     } else {
         std::cout << "Error: Map is empty" << std::endl;
         exit(1);
@@ -385,19 +1087,197 @@ bool MapSHPP<KeyType, ValueType>::isEmpty(){
 
 template<typename KeyType, typename ValueType>
 void MapSHPP<KeyType, ValueType>::clear(){
-    clearTree(mainNode);
-    count = 0;
-    mainNode = 0;
+    releaseAllNodes();
+}
+
+template<typename KeyType, typename ValueType>
+bool MapSHPP<KeyType, ValueType>::containsKey(const KeyType& key){
+    return findNode(key) != 0;
+}
+
+template<typename KeyType, typename ValueType>
+ValueType& MapSHPP<KeyType, ValueType>::operator [](const KeyType& key){
+    bool inserted;
+    return insertNode(key, inserted)->Value;
+}
+
+template<typename KeyType, typename ValueType>
+typename MapSHPP<KeyType, ValueType>::iterator MapSHPP<KeyType, ValueType>::begin(){
+    return iterator(iterator::leftmost(mainNode));
+}
+
+template<typename KeyType, typename ValueType>
+typename MapSHPP<KeyType, ValueType>::iterator MapSHPP<KeyType, ValueType>::end(){
+    return iterator();
+}
+
+template<typename KeyType, typename ValueType>
+typename MapSHPP<KeyType, ValueType>::iterator MapSHPP<KeyType, ValueType>::lowerBound(const KeyType& key){
+    BSTNode* result = 0;
+    BSTNode* node = mainNode;
+    while (node != 0){
+        if (node->Key < key){
+            node = node->right;
+        } else {
+            result = node;
+            if (!(key < node->Key)){
+                break;
+            }
+            node = node->left;
+        }
+    }
+    return iterator(result);
+}
+
+template<typename KeyType, typename ValueType>
+typename MapSHPP<KeyType, ValueType>::iterator MapSHPP<KeyType, ValueType>::upperBound(const KeyType& key){
+    BSTNode* result = 0;
+    BSTNode* node = mainNode;
+    while (node != 0){
+        if (key < node->Key){
+            result = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return iterator(result);
+}
+
+template<typename KeyType, typename ValueType>
+typename MapSHPP<KeyType, ValueType>::Range MapSHPP<KeyType, ValueType>::range(const KeyType& lo, const KeyType& hi){
+    if (!(lo < hi)){
+        return Range(end(), end());
+    }
+    return Range(lowerBound(lo), lowerBound(hi));
+}
+
+template<typename KeyType, typename ValueType>
+int MapSHPP<KeyType, ValueType>::rank(const KeyType& key){
+    int result = 0;
+    BSTNode* node = mainNode;
+    while (node != 0){
+        if (node->Key < key){
+            result += getNodeWeight(node->left) + 1;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return result;
+}
+
+template<typename KeyType, typename ValueType>
+const KeyType& MapSHPP<KeyType, ValueType>::select(int k){
+    if (k < 0 || k >= count){
+        std::cout << "Fatal error: index is not valid" << std::endl;
+        exit(1);
+    }
+    BSTNode* node = mainNode;
+    while (true){
+        int leftWeight = getNodeWeight(node->left);
+        if (k < leftWeight){
+            node = node->left;
+        } else if (k > leftWeight){
+            k -= leftWeight + 1;
+            node = node->right;
+        } else {
+            return node->Key;
+        }
+    }
+}
+
+template<typename KeyType, typename ValueType>
+int MapSHPP<KeyType, ValueType>::countInRange(const KeyType& lo, const KeyType& hi){
+    if (!(lo < hi)){
+        return 0;
+    }
+    return rank(hi) - rank(lo);
+}
+
+/* Implementation of all methods of MapSHPP::iterator class*/
+template<typename KeyType, typename ValueType>
+MapSHPP<KeyType, ValueType>::iterator::iterator(){
+    node = 0;
+}
+
+template<typename KeyType, typename ValueType>
+MapSHPP<KeyType, ValueType>::iterator::iterator(BSTNode* node){
+    this->node = node;
+}
+
+template<typename KeyType, typename ValueType>
+typename MapSHPP<KeyType, ValueType>::BSTNode* MapSHPP<KeyType, ValueType>::iterator::leftmost(BSTNode* node){
+    if (node != 0){
+        while (node->left != 0){
+            node = node->left;
+        }
+    }
+    return node;
+}
+
+template<typename KeyType, typename ValueType>
+const KeyType& MapSHPP<KeyType, ValueType>::iterator::key() const{
+    return node->Key;
+}
+
+template<typename KeyType, typename ValueType>
+ValueType& MapSHPP<KeyType, ValueType>::iterator::value() const{
+    return node->Value;
+}
+
+template<typename KeyType, typename ValueType>
+const KeyType& MapSHPP<KeyType, ValueType>::iterator::operator *() const{
+    return node->Key;
+}
+
+template<typename KeyType, typename ValueType>
+typename MapSHPP<KeyType, ValueType>::iterator& MapSHPP<KeyType, ValueType>::iterator::operator ++(){
+    if (node->right != 0){
+        node = leftmost(node->right);
+    } else {
+        /* Climb while coming from the right, the next parent is greater*/
+        BSTNode* child = node;
+        node = node->parent;
+        while (node != 0 && child == node->right){
+            child = node;
+            node = node->parent;
+        }
+    }
+    return *this;
+}
+
+template<typename KeyType, typename ValueType>
+typename MapSHPP<KeyType, ValueType>::iterator MapSHPP<KeyType, ValueType>::iterator::operator ++(int){
+    iterator previous = *this;
+    ++(*this);
+    return previous;
+}
+
+template<typename KeyType, typename ValueType>
+bool MapSHPP<KeyType, ValueType>::iterator::operator ==(const iterator& other) const{
+    return node == other.node;
+}
+
+template<typename KeyType, typename ValueType>
+bool MapSHPP<KeyType, ValueType>::iterator::operator !=(const iterator& other) const{
+    return !(*this == other);
+}
+
+template<typename KeyType, typename ValueType>
+MapSHPP<KeyType, ValueType>::Range::Range(const iterator& first, const iterator& last){
+    this->first = first;
+    this->last = last;
 }
 
 template<typename KeyType, typename ValueType>
-bool MapSHPP<KeyType, ValueType>::containsKey(KeyType key){
-    return findNode(mainNode, key) != 0;
+typename MapSHPP<KeyType, ValueType>::iterator MapSHPP<KeyType, ValueType>::Range::begin() const{
+    return first;
 }
 
 template<typename KeyType, typename ValueType>
-ValueType& MapSHPP<KeyType, ValueType>::operator [](KeyType key){
-    return findNode(mainNode, key)->Value;
+typename MapSHPP<KeyType, ValueType>::iterator MapSHPP<KeyType, ValueType>::Range::end() const{
+    return last;
 }
 
 #endif // MAPSHPP
@@ -0,0 +1,422 @@
+/* File: mpmcqueueshpp.h
+ * -----------------------------------------------------
+ * This file exports a bounded queue shared by many
+ * producer and many consumer threads.
+ */
+
+#ifndef MPMCQUEUESHPP_H
+#define MPMCQUEUESHPP_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+#include <type_traits>
+#include <utility>
+
+/* Class: MPMCQueueSHPP<ValueType>
+ * ---------------------------------------------------
+ * This class implements a queue of a fixed capacity for any number
+ * of producer and consumer threads. Every slot of the circular
+ * array has a sequence number that tells whether it waits for a
+ * producer or for a consumer of the current lap, so threads claim
+ * slots by one compare and swap of the shared index and never lock
+ * while the queue is neither full nor empty. Blocking methods sleep
+ * on a condition variable only when the queue is full or empty, and
+ * the other side locks the mutex only when someone sleeps. close()
+ * stops producers and wakes all sleeping threads; consumers still
+ * receive the elements left in the queue.
+ */
+template <typename ValueType>
+class MPMCQueueSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: MPMCQueueSHPP
+     * Usage: MPMCQueueSHPP<ValueType> queue(capacity);
+     * -----------------------------------------------
+     * Initializes a new empty queue for at least capacity
+     * elements, capacity is rounded up to a power of two
+     */
+    explicit MPMCQueueSHPP(int capacity);
+
+    /* Destructor: ~MPMCQueueSHPP
+     * ----------------------------------------------
+     * Destroys the elements left in the queue. No thread may
+     * use the queue at this moment
+     */
+    virtual ~MPMCQueueSHPP();
+
+    /* Method: tryEnqueue
+     * Usage: if (queue.tryEnqueue(value))...
+     * -----------------------------------------------
+     * Adds the value to the end of the queue. Returns false
+     * if the queue is full or closed
+     */
+    bool tryEnqueue(ValueType value);
+
+    /* Method: enqueue
+     * Usage: if (!queue.enqueue(value))...
+     * -----------------------------------------------
+     * Adds the value to the end of the queue, waiting while
+     * it is full. Returns false if the queue is closed
+     */
+    bool enqueue(ValueType value);
+
+    /* Method: tryDequeue
+     * Usage: if (queue.tryDequeue(value))...
+     * ---------------------------------------------
+     * Moves the first element of the queue to value. Returns
+     * false if the queue is empty
+     */
+    bool tryDequeue(ValueType& value);
+
+    /* Method: dequeue
+     * Usage: while (queue.dequeue(value))...
+     * ---------------------------------------------
+     * Moves the first element of the queue to value, waiting
+     * while the queue is empty. Returns false if the queue is
+     * closed and empty
+     */
+    bool dequeue(ValueType& value);
+
+    /* Method: tryDequeueFor
+     * Usage: if (queue.tryDequeueFor(value, std::chrono::milliseconds(10)))...
+     * ---------------------------------------------
+     * Works as dequeue, but waits not longer than timeout.
+     * Returns false if no element came in time
+     */
+    template<typename Rep, typename Period>
+    bool tryDequeueFor(ValueType& value, const std::chrono::duration<Rep, Period>& timeout);
+
+    /* Method: close
+     * Usage: queue.close();
+     * ---------------------------------------------
+     * Forbids new elements and wakes all waiting threads.
+     * An enqueue running at the same moment may still add
+     * its element
+     */
+    void close();
+
+    /* Method: isClosed
+     * Usage: if (queue.isClosed())...
+     * --------------------------------------------
+     * Returns true if close was called
+     */
+    bool isClosed() const;
+
+    /* Method: size
+     * Usage: int size = queue.size();
+     * --------------------------------------------
+     * Returns the number of the elements. Other threads may
+     * change it at any moment, so the result is only a hint
+     */
+    int size() const;
+
+    /* Method: isEmpty
+     * Usage: if (queue.isEmpty())...
+     * --------------------------------------------
+     * Returns true if the queue has no elements, a hint as size
+     */
+    bool isEmpty() const;
+
+    /* Method: capacity
+     * Usage: int capacity = queue.capacity();
+     * --------------------------------------------
+     * Returns the maximal number of the elements
+     */
+    int capacity() const;
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Size of the cache line*/
+    static const int CACHE_LINE = 64;
+
+    /* Slot of the array. sequence equals the index of the
+     * producer that may fill the slot, or this index + 1 when
+     * the slot is filled and waits for a consumer*/
+    struct Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(ValueType), alignof(ValueType)>::type storage;
+    };
+
+    /* Forbid copying, the queue is shared by many threads*/
+    MPMCQueueSHPP(const MPMCQueueSHPP<ValueType>& src);
+    MPMCQueueSHPP<ValueType>& operator=(const MPMCQueueSHPP<ValueType>& src);
+
+    /* Method: push
+     * Usage: if (push(value))...
+     * ------------------------------------------------
+     * Claims a free slot and moves value there. Returns false
+     * without touching value if the queue is full
+     */
+    bool push(ValueType& value);
+
+    /* Method: pop
+     * Usage: if (pop(value))...
+     * ------------------------------------------------
+     * Claims a filled slot and moves its element to value.
+     * Returns false if the queue is empty
+     */
+    bool pop(ValueType& value);
+
+    /* Method: waitDequeue
+     * Usage: if (waitDequeue(value, deadline))...
+     * ------------------------------------------------
+     * Sleeps until an element comes, the queue is closed or
+     * the deadline passes. A null deadline means no limit
+     */
+    bool waitDequeue(ValueType& value, const std::chrono::steady_clock::time_point *deadline);
+
+    /* Method: wake
+     * Usage: wake(waitingConsumers, notEmpty);
+     * ------------------------------------------------
+     * Wakes one thread sleeping on the condition, if there is
+     * one. Called after a slot changed its state
+     */
+    void wake(std::atomic<int>& waiting, std::condition_variable& condition);
+
+    char frontPadding[CACHE_LINE];
+
+    /* Array of the slots and the mask of its index*/
+    Cell *cells;
+    size_t mask;
+
+    char cellsPadding[CACHE_LINE];
+
+    /* Index of the next producer, grows without wrapping*/
+    std::atomic<size_t> enqueuePos;
+
+    char enqueuePadding[CACHE_LINE];
+
+    /* Index of the next consumer, grows without wrapping*/
+    std::atomic<size_t> dequeuePos;
+
+    char dequeuePadding[CACHE_LINE];
+
+    /* Sleeping threads and the numbers of them*/
+    std::mutex lock;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    std::atomic<int> waitingProducers;
+    std::atomic<int> waitingConsumers;
+    std::atomic<bool> closed;
+};
+
+
+/* Implementation of all methods of MPMCQueueSHPP class*/
+template <typename ValueType>
+MPMCQueueSHPP<ValueType> :: MPMCQueueSHPP(int capacity){
+    if (capacity < 1){
+        std::cout << "Fatal error: capacity is not valid" << std::endl;
+        exit(1);
+    }
+    /* One slot can not tell a full lap from an empty one*/
+    size_t size = 2;
+    while (size < (size_t)capacity){
+        size *= 2;
+    }
+    cells = new Cell[size];
+    for (size_t i = 0; i < size; i++){
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask = size - 1;
+    enqueuePos.store(0, std::memory_order_relaxed);
+    dequeuePos.store(0, std::memory_order_relaxed);
+    waitingProducers.store(0);
+    waitingConsumers.store(0);
+    closed.store(false);
+}
+
+template <typename ValueType>
+MPMCQueueSHPP<ValueType> :: ~MPMCQueueSHPP(){
+    if (!std::is_trivially_destructible<ValueType>::value){
+        size_t last = enqueuePos.load();
+        for (size_t pos = dequeuePos.load(); pos != last; pos++){
+            Cell *cell = cells + (pos & mask);
+            if (cell->sequence.load() == pos + 1){
+                reinterpret_cast<ValueType*>(&cell->storage)->~ValueType();
+            }
+        }
+    }
+    delete[] cells;
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: push(ValueType& value){
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true){
+        cell = cells + (pos & mask);
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)pos;
+        if (difference == 0){
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        } else if (difference < 0){
+            /* The slot still holds the element of the previous lap*/
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    new (&cell->storage) ValueType(std::move(value));
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: pop(ValueType& value){
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true){
+        cell = cells + (pos & mask);
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)(pos + 1);
+        if (difference == 0){
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        } else if (difference < 0){
+            /* The producer of this slot has not finished yet*/
+            return false;
+        } else {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+    ValueType *element = reinterpret_cast<ValueType*>(&cell->storage);
+    value = std::move(*element);
+    element->~ValueType();
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename ValueType>
+void MPMCQueueSHPP<ValueType> :: wake(std::atomic<int>& waiting, std::condition_variable& condition){
+    /* Pairs with the fence of the sleeping side: either it sees
+     * the new slot state or this thread sees it waiting*/
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) > 0){
+        std::lock_guard<std::mutex> guard(lock);
+        condition.notify_one();
+    }
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: tryEnqueue(ValueType value){
+    if (closed.load(std::memory_order_relaxed) || !push(value)){
+        return false;
+    }
+    wake(waitingConsumers, notEmpty);
+    return true;
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: enqueue(ValueType value){
+    if (closed.load(std::memory_order_relaxed)){
+        return false;
+    }
+    bool result = push(value);
+    if (!result){
+        std::unique_lock<std::mutex> guard(lock);
+        waitingProducers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!closed.load() && !(result = push(value))){
+            notFull.wait(guard);
+        }
+        waitingProducers.fetch_sub(1);
+    }
+    if (result){
+        wake(waitingConsumers, notEmpty);
+    }
+    return result;
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: tryDequeue(ValueType& value){
+    if (!pop(value)){
+        return false;
+    }
+    wake(waitingProducers, notFull);
+    return true;
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: dequeue(ValueType& value){
+    return waitDequeue(value, 0);
+}
+
+template <typename ValueType>
+template<typename Rep, typename Period>
+bool MPMCQueueSHPP<ValueType> :: tryDequeueFor(ValueType& value, const std::chrono::duration<Rep, Period>& timeout){
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+    return waitDequeue(value, &deadline);
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: waitDequeue(ValueType& value, const std::chrono::steady_clock::time_point *deadline){
+    bool result = pop(value);
+    if (!result){
+        std::unique_lock<std::mutex> guard(lock);
+        waitingConsumers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!(result = pop(value)) && !closed.load()){
+            if (deadline == 0){
+                notEmpty.wait(guard);
+            } else if (notEmpty.wait_until(guard, *deadline) == std::cv_status::timeout){
+                result = pop(value);
+                break;
+            }
+        }
+        waitingConsumers.fetch_sub(1);
+    }
+    if (result){
+        wake(waitingProducers, notFull);
+    }
+    return result;
+}
+
+template <typename ValueType>
+void MPMCQueueSHPP<ValueType> :: close(){
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        closed.store(true);
+    }
+    notFull.notify_all();
+    notEmpty.notify_all();
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: isClosed() const{
+    return closed.load();
+}
+
+template <typename ValueType>
+int MPMCQueueSHPP<ValueType> :: size() const{
+    size_t first = dequeuePos.load();
+    size_t last = enqueuePos.load();
+    if (last <= first){
+        return 0;
+    }
+    return last - first > mask + 1 ? (int)(mask + 1) : (int)(last - first);
+}
+
+template <typename ValueType>
+bool MPMCQueueSHPP<ValueType> :: isEmpty() const{
+    return size() == 0;
+}
+
+template <typename ValueType>
+int MPMCQueueSHPP<ValueType> :: capacity() const{
+    return (int)(mask + 1);
+}
+
+#endif // MPMCQUEUESHPP_H
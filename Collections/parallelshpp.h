@@ -0,0 +1,536 @@
+/* File: parallelshpp.h
+ * -----------------------------------
+ *
+ * This file exports a small work stealing thread
+ * pool and parallel versions of for each, transform,
+ * reduce and sort over VectorSHPP.
+ */
+
+#ifndef PARALLELSHPP_H
+#define PARALLELSHPP_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <stdint.h>
+#include "vectorshpp.h"
+
+/* The smallest number of elements processed by one task. Vectors
+ * shorter than two grains are processed by the calling thread.
+ * Define it before including this file to change it.
+ */
+#ifndef PARALLELSHPP_GRAIN
+#define PARALLELSHPP_GRAIN 4096
+#endif
+
+/* Number of the workers of the shared pool, -1 means one less
+ * than the number of cores
+ */
+#ifndef PARALLELSHPP_THREADS
+#define PARALLELSHPP_THREADS -1
+#endif
+
+/* Class: ThreadPoolSHPP
+ * --------------------------------
+ * This class implements a pool of worker threads. Every worker has
+ * its own queue of tasks: it takes the newest task from its queue
+ * and, when the queue is empty, steals the oldest task of another
+ * worker. A thread that waits for its tasks runs queued tasks
+ * itself, so parallel functions may be called from inside tasks.
+ */
+class ThreadPoolSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: ThreadPoolSHPP
+     * Usage: ThreadPoolSHPP pool(workers);
+     * -----------------------------------------------------
+     * Starts the received number of workers, by default one
+     * less than the number of cores, because the calling thread
+     * works too
+     */
+    explicit ThreadPoolSHPP(int workers = -1){
+        if (workers < 0){
+            workers = (int)std::thread::hardware_concurrency() - 1;
+        }
+        workerCount = workers < 0 ? 0 : workers;
+        stopping = false;
+        queued = 0;
+        nextQueue = 0;
+        queues = new Queue[workerCount > 0 ? workerCount : 1];
+        threads = new std::thread[workerCount > 0 ? workerCount : 1];
+        for (int i = 0; i < workerCount; i++){
+            threads[i] = std::thread(&ThreadPoolSHPP::workerLoop, this, i);
+        }
+    }
+
+    /* Destructor: ~ThreadPoolSHPP
+     * -----------------------------------------------------
+     * Stops and joins all workers
+     */
+    virtual ~ThreadPoolSHPP(){
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (int i = 0; i < workerCount; i++){
+            threads[i].join();
+        }
+        delete[] threads;
+        delete[] queues;
+    }
+
+    /* Method: shared
+     * Usage: ThreadPoolSHPP& pool = ThreadPoolSHPP::shared();
+     * -----------------------------------------------------
+     * Returns the pool used by the parallel functions, it is
+     * started on the first call with PARALLELSHPP_THREADS workers
+     */
+    static ThreadPoolSHPP& shared(){
+        static ThreadPoolSHPP pool(PARALLELSHPP_THREADS);
+        return pool;
+    }
+
+    /* Method: size
+     * Usage: int workers = pool.size();
+     * -----------------------------------------------------
+     * Returns the number of the worker threads
+     */
+    int size() const{
+        return workerCount;
+    }
+
+    /* Method: submit
+     * Usage: pool.submit(task);
+     * -----------------------------------------------------
+     * Queues the task. A worker puts it to its own queue, other
+     * threads spread tasks over the queues in turn. Without
+     * workers the task runs at once
+     */
+    void submit(std::function<void()> task){
+        if (workerCount == 0){
+            task();
+            return;
+        }
+        int index = currentWorker();
+        if (index < 0){
+            index = (int)(nextQueue.fetch_add(1) % (unsigned)workerCount);
+        }
+        {
+            std::lock_guard<std::mutex> guard(queues[index].lock);
+            queues[index].tasks.push_back(std::move(task));
+        }
+        queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+        }
+        wakeUp.notify_one();
+    }
+
+    /* Method: runPending
+     * Usage: if (!pool.runPending()) ...
+     * -----------------------------------------------------
+     * Runs one queued task in the calling thread. Returns false
+     * if there was no task
+     */
+    bool runPending(){
+        std::function<void()> task;
+        int index = currentWorker();
+        if (!takeTask(index < 0 ? 0 : index, task)){
+            return false;
+        }
+        task();
+        return true;
+    }
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Size of the cache line*/
+    static const int CACHE_LINE = 64;
+
+    /* Queue of one worker. Padding keeps locks of neighbouring
+     * queues in different cache lines*/
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()> > tasks;
+        char padding[CACHE_LINE];
+    };
+
+    /* Forbid copying, the pool owns its threads*/
+    ThreadPoolSHPP(const ThreadPoolSHPP& src);
+    ThreadPoolSHPP& operator=(const ThreadPoolSHPP& src);
+
+    /* Method: currentWorker
+     * -----------------------------------------------
+     * Returns index of the worker running in this thread,
+     * -1 for other threads
+     */
+    static int& currentWorker(){
+        static thread_local int index = -1;
+        return index;
+    }
+
+    /* Method: takeTask
+     * -----------------------------------------------
+     * Takes the newest task of the own queue or the oldest
+     * task of another queue. Returns false if all are empty
+     */
+    bool takeTask(int own, std::function<void()>& task){
+        if (queued.load() == 0){
+            return false;
+        }
+        for (int i = 0; i < workerCount; i++){
+            int index = (own + i) % workerCount;
+            std::lock_guard<std::mutex> guard(queues[index].lock);
+            std::deque<std::function<void()> >& tasks = queues[index].tasks;
+            if (!tasks.empty()){
+                if (i == 0){
+                    task = std::move(tasks.back());
+                    tasks.pop_back();
+                } else {
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Method: workerLoop
+     * -----------------------------------------------
+     * Body of the worker thread: runs tasks and sleeps when
+     * there are none
+     */
+    void workerLoop(int index){
+        currentWorker() = index;
+        std::function<void()> task;
+        while (true){
+            if (takeTask(index, task)){
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wakeUp.wait(guard, [this]() { return stopping || queued.load() > 0; });
+            if (stopping){
+                return;
+            }
+        }
+    }
+
+    /* Queues of the workers*/
+    Queue *queues;
+
+    /* Worker threads*/
+    std::thread *threads;
+
+    /* Number of the workers*/
+    int workerCount;
+
+    /* Number of the tasks in all queues*/
+    std::atomic<int> queued;
+
+    /* Queue for the next task from a thread outside the pool*/
+    std::atomic<unsigned> nextQueue;
+
+    /* Sleeping workers wait here for new tasks*/
+    std::mutex sleepLock;
+    std::condition_variable wakeUp;
+    bool stopping;
+};
+
+
+/* Struct: ParallelSHPP
+ * --------------------------------
+ * Helpers of the parallel functions
+ */
+struct ParallelSHPP{
+
+    /* Method: runChunks
+     * Usage: ParallelSHPP::runChunks(chunks, [&](int chunk) { ... });
+     * -----------------------------------------------------
+     * Calls body for every chunk index in [0, chunks). The calling
+     * thread and up to one helper per worker take the next chunk
+     * from a shared counter, so faster threads do more chunks.
+     * Returns when all chunks are done
+     */
+    template<typename Body>
+    static void runChunks(int chunks, const Body& body){
+        if (chunks <= 0){
+            return;
+        }
+        ThreadPoolSHPP& pool = ThreadPoolSHPP::shared();
+        int helpers = pool.size() < chunks - 1 ? pool.size() : chunks - 1;
+        std::atomic<int> next(0);
+        std::atomic<int> finished(0);
+        auto loop = [&]() {
+            for (int chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1)){
+                body(chunk);
+            }
+        };
+        for (int i = 0; i < helpers; i++){
+            pool.submit([&]() {
+                loop();
+                finished.fetch_add(1);
+            });
+        }
+        loop();
+        /* Helpers link to this frame, wait for all of them*/
+        while (finished.load() < helpers){
+            if (!pool.runPending()){
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /* Method: chunkBounds
+     * Usage: int chunks = ParallelSHPP::chunkBounds(array, n, bounds, MAX_CHUNKS);
+     * -----------------------------------------------------
+     * Splits n elements into chunks of at least one grain, a few
+     * chunks per thread. Inner bounds are moved to the cache line
+     * borders, so two tasks never write the same line. Writes
+     * chunks + 1 bounds and returns the number of chunks
+     */
+    template<typename ValueType>
+    static int chunkBounds(const ValueType *array, int n, int bounds[], int maxChunks){
+        int threads = ThreadPoolSHPP::shared().size() + 1;
+        int chunks = threads == 1 ? 1 : threads * 4;
+        if (chunks > n / PARALLELSHPP_GRAIN){
+            chunks = n / PARALLELSHPP_GRAIN;
+        }
+        if (chunks > maxChunks){
+            chunks = maxChunks;
+        }
+        if (chunks < 1){
+            chunks = 1;
+        }
+        int perLine = CACHE_LINE % sizeof(ValueType) == 0 ? CACHE_LINE / (int)sizeof(ValueType) : 1;
+        /* Index of the first element that starts a cache line*/
+        int shift = (int)((CACHE_LINE - (uintptr_t)array % CACHE_LINE) % CACHE_LINE / sizeof(ValueType)) % perLine;
+        bounds[0] = 0;
+        for (int i = 1; i < chunks; i++){
+            long long bound = (long long)n * i / chunks;
+            bound = (bound - shift + perLine - 1) / perLine * perLine + shift;
+            bounds[i] = bound > n ? n : (int)bound;
+        }
+        bounds[chunks] = n;
+        return chunks;
+    }
+
+    /* Method: mergeSplit
+     * Usage: int i = ParallelSHPP::mergeSplit(a, aCount, b, bCount, k, less);
+     * -----------------------------------------------------
+     * Returns how many elements of a go into the first k elements
+     * of the stable merge of the sorted a and b
+     */
+    template<typename ValueType, typename Compare>
+    static int mergeSplit(const ValueType *a, int aCount, const ValueType *b, int bCount, int k, Compare& less){
+        int low = k > bCount ? k - bCount : 0;
+        int high = k < aCount ? k : aCount;
+        while (low < high){
+            int middle = (low + high) / 2;
+            if (less(b[k - middle - 1], a[middle])){
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        return low;
+    }
+
+    /* Upper limit of the chunks of one call*/
+    static const int MAX_CHUNKS = 1024;
+
+    /* Size of the cache line*/
+    static const int CACHE_LINE = 64;
+};
+
+
+/* Function: parallelForEach
+ * Usage: parallelForEach(vector, [](ValueType& value) { ... });
+ * -----------------------------------------------------
+ * Calls function for every element of the vector from several
+ * threads. Calls for different elements must not depend on
+ * each other, function must not throw
+ */
+template<typename ValueType, typename Function>
+void parallelForEach(VectorSHPP<ValueType>& vector, Function function){
+    ValueType *array = vector.data();
+    int bounds[ParallelSHPP::MAX_CHUNKS + 1];
+    int chunks = ParallelSHPP::chunkBounds(array, vector.size(), bounds, ParallelSHPP::MAX_CHUNKS);
+    ParallelSHPP::runChunks(chunks, [&](int chunk) {
+        for (int i = bounds[chunk]; i < bounds[chunk + 1]; i++){
+            function(array[i]);
+        }
+    });
+}
+
+template<typename ValueType, typename Function>
+void parallelForEach(const VectorSHPP<ValueType>& vector, Function function){
+    const ValueType *array = vector.data();
+    int bounds[ParallelSHPP::MAX_CHUNKS + 1];
+    int chunks = ParallelSHPP::chunkBounds(array, vector.size(), bounds, ParallelSHPP::MAX_CHUNKS);
+    ParallelSHPP::runChunks(chunks, [&](int chunk) {
+        for (int i = bounds[chunk]; i < bounds[chunk + 1]; i++){
+            function(array[i]);
+        }
+    });
+}
+
+/* Function: parallelTransform
+ * Usage: parallelTransform(source, result, [](const ValueType& value) { return ...; });
+ * -----------------------------------------------------
+ * Makes result of the same size as source and puts
+ * function(source[i]) to result[i], using several threads
+ */
+template<typename ValueType, typename ResultType, typename Function>
+void parallelTransform(const VectorSHPP<ValueType>& source, VectorSHPP<ResultType>& result, Function function){
+    result.resize(source.size());
+    const ValueType *from = source.data();
+    ResultType *to = result.data();
+    int bounds[ParallelSHPP::MAX_CHUNKS + 1];
+    /* Bounds follow the written array*/
+    int chunks = ParallelSHPP::chunkBounds(to, source.size(), bounds, ParallelSHPP::MAX_CHUNKS);
+    ParallelSHPP::runChunks(chunks, [&](int chunk) {
+        for (int i = bounds[chunk]; i < bounds[chunk + 1]; i++){
+            to[i] = function(from[i]);
+        }
+    });
+}
+
+/* Function: parallelReduce
+ * Usage: long long total = parallelReduce(vector, 0LL, [](long long a, long long b) { return a + b; });
+ * -----------------------------------------------------
+ * Combines all elements by the associative operation. Every
+ * chunk is combined starting from identity, then the
+ * partial results are combined in the order of the chunks.
+ * identity must not change a value it is combined with
+ */
+template<typename ValueType, typename ResultType, typename Operation>
+ResultType parallelReduce(const VectorSHPP<ValueType>& vector, ResultType identity, Operation operation){
+    struct Partial {
+        ResultType value;
+        char padding[ParallelSHPP::CACHE_LINE];
+    };
+    const ValueType *array = vector.data();
+    int bounds[ParallelSHPP::MAX_CHUNKS + 1];
+    int chunks = ParallelSHPP::chunkBounds(array, vector.size(), bounds, ParallelSHPP::MAX_CHUNKS);
+    VectorSHPP<Partial> partials;
+    partials.resize(chunks);
+    ParallelSHPP::runChunks(chunks, [&](int chunk) {
+        ResultType value = identity;
+        for (int i = bounds[chunk]; i < bounds[chunk + 1]; i++){
+            value = operation(value, array[i]);
+        }
+        partials[chunk].value = value;
+    });
+    ResultType result = identity;
+    for (int i = 0; i < chunks; i++){
+        result = operation(result, partials[i].value);
+    }
+    return result;
+}
+
+/* Function: parallelSort
+ * Usage: parallelSort(vector);
+ *        parallelSort(vector, [](const ValueType& a, const ValueType& b) { return ...; });
+ * -----------------------------------------------------
+ * Sorts the vector using several threads. Chunks are sorted
+ * by std::sort at the same time, then sorted runs are merged in
+ * pairs. Every merge is split into parts along the merge path,
+ * so all threads work until the last merge. Like std::sort it
+ * does not keep the order of equal elements. Needs an additional
+ * buffer of default constructed elements of the vector size
+ */
+template<typename ValueType, typename Compare>
+void parallelSort(VectorSHPP<ValueType>& vector, Compare less){
+    int n = vector.size();
+    ValueType *array = vector.data();
+    int threads = ThreadPoolSHPP::shared().size() + 1;
+    if (threads == 1 || n < 2 * PARALLELSHPP_GRAIN){
+        std::sort(array, array + n, less);
+        return;
+    }
+
+    /* Number of the runs is a power of two, so runs merge in pairs*/
+    int runs = 1;
+    while (runs < threads && runs * 2 <= n / PARALLELSHPP_GRAIN && runs * 2 <= ParallelSHPP::MAX_CHUNKS){
+        runs *= 2;
+    }
+    int runBounds[ParallelSHPP::MAX_CHUNKS + 1];
+    for (int i = 0; i <= runs; i++){
+        runBounds[i] = (int)((long long)n * i / runs);
+    }
+    ParallelSHPP::runChunks(runs, [&](int run) {
+        std::sort(array + runBounds[run], array + runBounds[run + 1], less);
+    });
+
+    VectorSHPP<ValueType> buffer;
+    buffer.resize(n);
+    ValueType *from = array;
+    ValueType *to = buffer.data();
+    int partSize = n / (threads * 4);
+    if (partSize < PARALLELSHPP_GRAIN){
+        partSize = PARALLELSHPP_GRAIN;
+    }
+    for (int width = 1; width < runs; width *= 2){
+        int pairs = runs / (2 * width);
+        int partsPerPair = (2 * (n / runs) * width) / partSize + 1;
+        if (partsPerPair * pairs > ParallelSHPP::MAX_CHUNKS){
+            partsPerPair = ParallelSHPP::MAX_CHUNKS / pairs;
+        }
+        /* Splits are found before merging, because merges move
+         * elements out of the runs searched by the other parts*/
+        int splits[ParallelSHPP::MAX_CHUNKS];
+        auto locate = [&](int task, int& aStart, int& bStart, int& aCount, int& bCount, int& kStart, int& kEnd) {
+            int pair = task / partsPerPair;
+            int part = task % partsPerPair;
+            aStart = runBounds[pair * 2 * width];
+            bStart = runBounds[pair * 2 * width + width];
+            aCount = bStart - aStart;
+            bCount = runBounds[(pair + 1) * 2 * width] - bStart;
+            kStart = (int)((long long)(aCount + bCount) * part / partsPerPair);
+            kEnd = (int)((long long)(aCount + bCount) * (part + 1) / partsPerPair);
+        };
+        ParallelSHPP::runChunks(pairs * partsPerPair, [&](int task) {
+            int aStart, bStart, aCount, bCount, kStart, kEnd;
+            locate(task, aStart, bStart, aCount, bCount, kStart, kEnd);
+            splits[task] = ParallelSHPP::mergeSplit(from + aStart, aCount, from + bStart, bCount, kStart, less);
+        });
+        ParallelSHPP::runChunks(pairs * partsPerPair, [&](int task) {
+            int aStart, bStart, aCount, bCount, kStart, kEnd;
+            locate(task, aStart, bStart, aCount, bCount, kStart, kEnd);
+            int iStart = splits[task];
+            int iEnd = task % partsPerPair == partsPerPair - 1 ? aCount : splits[task + 1];
+            std::merge(std::make_move_iterator(from + aStart + iStart), std::make_move_iterator(from + aStart + iEnd),
+                       std::make_move_iterator(from + bStart + kStart - iStart), std::make_move_iterator(from + bStart + kEnd - iEnd),
+                       to + aStart + kStart, less);
+        });
+        std::swap(from, to);
+    }
+    if (from != array){
+        int bounds[ParallelSHPP::MAX_CHUNKS + 1];
+        int chunks = ParallelSHPP::chunkBounds(array, n, bounds, ParallelSHPP::MAX_CHUNKS);
+        ParallelSHPP::runChunks(chunks, [&](int chunk) {
+            std::move(from + bounds[chunk], from + bounds[chunk + 1], array + bounds[chunk]);
+        });
+    }
+}
+
+template<typename ValueType>
+void parallelSort(VectorSHPP<ValueType>& vector){
+    parallelSort(vector, std::less<ValueType>());
+}
+
+#endif // PARALLELSHPP_H
@@ -0,0 +1,655 @@
+/* File: persistentmapshpp.h
+ * --------------------------------------------------
+ * This interface exports a persistent version of map
+ * based on AVL binary search tree. Every change makes
+ * a new version of the tree that shares all untouched
+ * nodes with the previous one, so taking a snapshot
+ * is O(1) and snapshots never change.
+ */
+#ifndef PERSISTENTMAPSHPP_H
+#define PERSISTENTMAPSHPP_H
+
+#include <iostream>
+#include <stdlib.h>
+#include <memory>
+#include <mutex>
+
+
+/* Class: PersistentMapSHPP
+ * -------------------------------------------------
+ * This class implements map of a specified ValueType
+ * elements. Nodes are immutable and reference counted,
+ * put and remove copy only the path from the root to the
+ * changed node and then publish the new root atomically.
+ * Writers are serialized by the map, readers work with
+ * snapshots and never take locks while traversing them.
+ * Taking a snapshot is not lock free: the root is read by
+ * std::atomic_load, which libstdc++ guards by a global
+ * striped mutex held only while the pointer and its count
+ * are copied.
+ * Values are copied along the changed path, so they
+ * should be cheap to copy.
+ */
+template<typename KeyType, typename ValueType>
+class PersistentMapSHPP{
+
+    /* Structure for storing key-value pairs and build BST*/
+    struct BSTNode;
+    typedef std::shared_ptr<const BSTNode> NodePtr;
+
+    /* Public methods prototypes*/
+public:
+
+    class Snapshot;
+
+    /* Constructor: PersistentMapSHPP
+     * Usage: PersistentMapSHPP<KeyType, ValueType> map;
+     * -----------------------------------------------------
+     * Initializes a new empty map
+     */
+    PersistentMapSHPP();
+
+    /* Destructor: ~PersistentMapSHPP
+    * ----------------------------------------------
+    * Releases the current version. Nodes shared with
+    * living snapshots stay alive until they are released
+    */
+    virtual ~PersistentMapSHPP();
+
+    /* Method: put
+     * Usage: map.put(key, value);
+     * -----------------------------------------------
+     * Put the value in accordance with the key.
+     * If this key already exists then its value is replaced by a new
+     */
+    void put(const KeyType& key, const ValueType& value);
+
+    /* Method: remove
+     * Usage: map.remove(key);
+     * -----------------------------------------------------
+     * Removes value of the map corresponding to the key,
+     * does nothing if the key is absent
+     */
+    void remove(const KeyType& key);
+
+    /* Method: get
+     * Usage: value = map.get(key);
+     * -----------------------------------------------
+     * Returns the value of the corresponding key in the
+     * current version
+     */
+    ValueType get(const KeyType& key);
+
+    /* Method: containsKey
+     * Usage: if (map.containsKey(key))
+     * -----------------------------------------------------
+     * Return true if current version contains input key
+     */
+    bool containsKey(const KeyType& key);
+
+    /* Method: size
+     * Usage: int size = map.size();
+     * --------------------------------------------
+     * Return current number of the elements of the
+     * map
+     */
+    int size();
+
+    /* Method: isEmpty
+     * Usage: if (map.isEmpty());
+     * -----------------------------------------------
+     * Returns true if map is empty
+     */
+    bool isEmpty();
+
+    /* Method: clear
+     * Usage: map.clear();
+     * ---------------------------------------------
+     * Removes all elements of the map
+     */
+    void clear();
+
+    /* Method: snapshot
+     * Usage: PersistentMapSHPP<KeyType, ValueType>::Snapshot view = map.snapshot();
+     * ---------------------------------------------
+     * Returns the current version of the map in O(1).
+     * Later changes of the map are not visible in it
+     */
+    Snapshot snapshot();
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    struct BSTNode {
+        BSTNode(const KeyType& key, const ValueType& value, const NodePtr& left, const NodePtr& right)
+            : Key(key), Value(value), left(left), right(right) {}
+        KeyType Key;
+        ValueType Value;
+        int length;
+        int weight;
+        NodePtr left;
+        NodePtr right;
+    };
+
+public:
+
+    /* Class: Snapshot
+     * -------------------------------------------------
+     * Immutable version of the map. May be copied, kept and
+     * read from any thread without synchronization
+     */
+    class Snapshot {
+    public:
+
+        class iterator;
+
+        /* Constructor: Snapshot
+         * Usage: PersistentMapSHPP<KeyType, ValueType>::Snapshot view;
+         * -----------------------------------------------
+         * Initializes an empty snapshot
+         */
+        Snapshot();
+
+        /* Method: get
+         * Usage: value = view.get(key);
+         * -----------------------------------------------
+         * Returns the value of the corresponding key
+         */
+        const ValueType& get(const KeyType& key) const;
+
+        /* Method: containsKey
+         * Usage: if (view.containsKey(key))
+         * -----------------------------------------------
+         * Return true if snapshot contains input key
+         */
+        bool containsKey(const KeyType& key) const;
+
+        /* Method: size
+         * Usage: int size = view.size();
+         * -----------------------------------------------
+         * Return number of the elements in the snapshot
+         */
+        int size() const;
+
+        /* Method: isEmpty
+         * Usage: if (view.isEmpty())
+         * -----------------------------------------------
+         * Returns true if snapshot is empty
+         */
+        bool isEmpty() const;
+
+        /* Method: begin
+         * Usage: for (auto it = view.begin(); it != view.end(); ++it)
+         * -----------------------------------------------
+         * Returns iterator to the element with the smallest key
+         */
+        iterator begin() const;
+
+        /* Method: end
+         * Usage: it != view.end()
+         * -----------------------------------------------
+         * Returns iterator that points past the element with
+         * the largest key
+         */
+        iterator end() const;
+
+        /* Class: iterator
+         * -------------------------------------------------
+         * In-order iterator over the snapshot. Nodes are shared
+         * by many versions and can not link to a parent, so the
+         * iterator keeps the not yet visited ancestors in a heap
+         * buffer sized by the tree height. end() allocates
+         * nothing. Must not outlive the snapshot it was taken from
+         */
+        class iterator {
+        public:
+            iterator();
+            iterator(const iterator& src);
+            iterator& operator=(const iterator& src);
+            ~iterator();
+            const KeyType& key() const;
+            const ValueType& value() const;
+            const KeyType& operator*() const;
+            iterator& operator++();
+            iterator operator++(int);
+            bool operator==(const iterator& other) const;
+            bool operator!=(const iterator& other) const;
+
+        private:
+            friend class Snapshot;
+
+            /* Creates an iterator whose stack holds height nodes*/
+            explicit iterator(int height);
+
+            /* Method: deepCopy
+             * -----------------------------------------------
+             * Copies the stack of src to a new buffer
+             */
+            void deepCopy(const iterator& src);
+
+            /* Pushes the node and all its left descendants*/
+            void pushLeftPath(const BSTNode* node);
+
+            /* Ancestors whose keys are not visited yet, the top is current*/
+            const BSTNode** path;
+
+            /* Size of the path buffer, never less than the tree height*/
+            int capacity;
+
+            /* Current depth of the path stack*/
+            int depth;
+        };
+
+    private:
+        friend class PersistentMapSHPP;
+
+        explicit Snapshot(const NodePtr& root);
+
+        /* Method: findNode
+         * -----------------------------------------------
+         * Returns pointer to the node that contains received
+         * key or 0 if such node not found
+         */
+        const BSTNode* findNode(const KeyType& key) const;
+
+        /* Root of the version*/
+        NodePtr root;
+    };
+
+private:
+
+    /* Forbid copying, use snapshot() to share the content*/
+    PersistentMapSHPP(const PersistentMapSHPP& src);
+    PersistentMapSHPP& operator=(const PersistentMapSHPP& src);
+
+    /* Method: getNodeHeight
+     * --------------------------------------------------
+     * Counts the height of a binary tree
+     */
+    static int getNodeHeight(const NodePtr& node);
+
+    /* Method: getNodeWeight
+     * --------------------------------------------------
+     * Counts the number of the nodes in a binary tree
+     */
+    static int getNodeWeight(const NodePtr& node);
+
+    /* Method: createNode
+     * --------------------------------------------------
+     * Creates new node with received content and links
+     */
+    static NodePtr createNode(const KeyType& key, const ValueType& value, const NodePtr& left, const NodePtr& right);
+
+    /* Method: balanceTree
+     * ---------------------------------------------------
+     * Creates node with received content and sub-trees whose
+     * heights differ by at most two, rotating new nodes if the
+     * difference is two
+     */
+    static NodePtr balanceTree(const KeyType& key, const ValueType& value, const NodePtr& left, const NodePtr& right);
+
+    /* Method: insertNode
+     * -----------------------------------------------
+     * Returns new version of the sub-tree with received
+     * key and value
+     */
+    static NodePtr insertNode(const NodePtr& node, const KeyType& key, const ValueType& value);
+
+    /* Method: removeNode
+     * -----------------------------------------------
+     * Returns new version of the sub-tree without received
+     * key. Returns the same sub-tree if key is absent
+     */
+    static NodePtr removeNode(const NodePtr& node, const KeyType& key);
+
+    /* Method: removeMinNode
+     * -----------------------------------------------
+     * Returns new version of the sub-tree without its
+     * minimal element
+     */
+    static NodePtr removeMinNode(const NodePtr& node);
+
+    /* Method: loadRoot, storeRoot
+     * -----------------------------------------------
+     * Read and publish the root of the current version
+     * atomically. std::atomic<std::shared_ptr> is not used:
+     * it takes a lock too, and its load in libstdc++ 12
+     * releases the lock with relaxed order, which races
+     * with the next store
+     */
+    NodePtr loadRoot() const;
+    void storeRoot(const NodePtr& root);
+
+    /* Root of the current version, accessed only by loadRoot and storeRoot*/
+    NodePtr mainNode;
+
+    /* Serializes writers*/
+    std::mutex writeLock;
+};
+
+
+template<typename KeyType, typename ValueType>
+PersistentMapSHPP<KeyType, ValueType>::PersistentMapSHPP(){
+}
+
+template<typename KeyType, typename ValueType>
+PersistentMapSHPP<KeyType, ValueType>::~PersistentMapSHPP(){
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::NodePtr PersistentMapSHPP<KeyType, ValueType>::loadRoot() const{
+    return std::atomic_load(&mainNode);
+}
+
+template<typename KeyType, typename ValueType>
+void PersistentMapSHPP<KeyType, ValueType>::storeRoot(const NodePtr& root){
+    std::atomic_store(&mainNode, root);
+}
+
+template<typename KeyType, typename ValueType>
+int PersistentMapSHPP<KeyType, ValueType>::getNodeHeight(const NodePtr& node){
+    if (node){
+        return node->length;
+    }
+    return 0;
+}
+
+template<typename KeyType, typename ValueType>
+int PersistentMapSHPP<KeyType, ValueType>::getNodeWeight(const NodePtr& node){
+    if (node){
+        return node->weight;
+    }
+    return 0;
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::NodePtr PersistentMapSHPP<KeyType, ValueType>::createNode(const KeyType& key, const ValueType& value, const NodePtr& left, const NodePtr& right){
+    std::shared_ptr<BSTNode> node = std::make_shared<BSTNode>(key, value, left, right);
+    if (getNodeHeight(left) > getNodeHeight(right)){
+        node->length = getNodeHeight(left) + 1;
+    } else {
+        node->length = getNodeHeight(right) + 1;
+    }
+    node->weight = getNodeWeight(left) + getNodeWeight(right) + 1;
+    return node;
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::NodePtr PersistentMapSHPP<KeyType, ValueType>::balanceTree(const KeyType& key, const ValueType& value, const NodePtr& left, const NodePtr& right){
+    int balanceFactor = getNodeHeight(right) - getNodeHeight(left);
+    if (balanceFactor == 2){
+        if (getNodeHeight(right->left) > getNodeHeight(right->right)){
+            const NodePtr& middle = right->left;
+            return createNode(middle->Key, middle->Value,
+                              createNode(key, value, left, middle->left),
+                              createNode(right->Key, right->Value, middle->right, right->right));
+        }
+        return createNode(right->Key, right->Value, createNode(key, value, left, right->left), right->right);
+    }
+    if (balanceFactor == -2){
+        if (getNodeHeight(left->right) > getNodeHeight(left->left)){
+            const NodePtr& middle = left->right;
+            return createNode(middle->Key, middle->Value,
+                              createNode(left->Key, left->Value, left->left, middle->left),
+                              createNode(key, value, middle->right, right));
+        }
+        return createNode(left->Key, left->Value, left->left, createNode(key, value, left->right, right));
+    }
+    return createNode(key, value, left, right);
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::NodePtr PersistentMapSHPP<KeyType, ValueType>::insertNode(const NodePtr& node, const KeyType& key, const ValueType& value){
+    if (!node){
+        return createNode(key, value, NodePtr(), NodePtr());
+    } else if (key < node->Key){
+        return balanceTree(node->Key, node->Value, insertNode(node->left, key, value), node->right);
+    } else if (node->Key < key){
+        return balanceTree(node->Key, node->Value, node->left, insertNode(node->right, key, value));
+    }
+    return createNode(node->Key, value, node->left, node->right);
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::NodePtr PersistentMapSHPP<KeyType, ValueType>::removeMinNode(const NodePtr& node){
+    if (!node->left){
+        return node->right;
+    }
+    return balanceTree(node->Key, node->Value, removeMinNode(node->left), node->right);
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::NodePtr PersistentMapSHPP<KeyType, ValueType>::removeNode(const NodePtr& node, const KeyType& key){
+    if (!node){
+        return node;
+    } else if (key < node->Key){
+        NodePtr newLeft = removeNode(node->left, key);
+        if (newLeft == node->left){
+            return node;
+        }
+        return balanceTree(node->Key, node->Value, newLeft, node->right);
+    } else if (node->Key < key){
+        NodePtr newRight = removeNode(node->right, key);
+        if (newRight == node->right){
+            return node;
+        }
+        return balanceTree(node->Key, node->Value, node->left, newRight);
+    }
+    if (!node->right){
+        return node->left;
+    }
+    const BSTNode* minNode = node->right.get();
+    while (minNode->left){
+        minNode = minNode->left.get();
+    }
+    return balanceTree(minNode->Key, minNode->Value, node->left, removeMinNode(node->right));
+}
+
+template<typename KeyType, typename ValueType>
+void PersistentMapSHPP<KeyType, ValueType>::put(const KeyType& key, const ValueType& value){
+    std::lock_guard<std::mutex> guard(writeLock);
+    NodePtr newRoot = insertNode(loadRoot(), key, value);
+    storeRoot(newRoot);
+}
+
+template<typename KeyType, typename ValueType>
+void PersistentMapSHPP<KeyType, ValueType>::remove(const KeyType& key){
+    std::lock_guard<std::mutex> guard(writeLock);
+    NodePtr oldRoot = loadRoot();
+    if (!oldRoot){
+        std::cout << "Error: Map is empty" << std::endl;
+        exit(1);
+    }
+    NodePtr newRoot = removeNode(oldRoot, key);
+    if (newRoot != oldRoot){
+        storeRoot(newRoot);
+    }
+}
+
+template<typename KeyType, typename ValueType>
+ValueType PersistentMapSHPP<KeyType, ValueType>::get(const KeyType& key){
+    return snapshot().get(key);
+}
+
+template<typename KeyType, typename ValueType>
+bool PersistentMapSHPP<KeyType, ValueType>::containsKey(const KeyType& key){
+    return snapshot().containsKey(key);
+}
+
+template<typename KeyType, typename ValueType>
+int PersistentMapSHPP<KeyType, ValueType>::size(){
+    return getNodeWeight(loadRoot());
+}
+
+template<typename KeyType, typename ValueType>
+bool PersistentMapSHPP<KeyType, ValueType>::isEmpty(){
+    return size() == 0;
+}
+
+template<typename KeyType, typename ValueType>
+void PersistentMapSHPP<KeyType, ValueType>::clear(){
+    std::lock_guard<std::mutex> guard(writeLock);
+    storeRoot(NodePtr());
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::Snapshot PersistentMapSHPP<KeyType, ValueType>::snapshot(){
+    return Snapshot(loadRoot());
+}
+
+/* Implementation of all methods of PersistentMapSHPP::Snapshot class*/
+template<typename KeyType, typename ValueType>
+PersistentMapSHPP<KeyType, ValueType>::Snapshot::Snapshot(){
+}
+
+template<typename KeyType, typename ValueType>
+PersistentMapSHPP<KeyType, ValueType>::Snapshot::Snapshot(const NodePtr& root) : root(root){
+}
+
+template<typename KeyType, typename ValueType>
+const typename PersistentMapSHPP<KeyType, ValueType>::BSTNode* PersistentMapSHPP<KeyType, ValueType>::Snapshot::findNode(const KeyType& key) const{
+    const BSTNode* node = root.get();
+    while (node != 0){
+        if (key < node->Key){
+            node = node->left.get();
+        } else if (node->Key < key){
+            node = node->right.get();
+        } else {
+            return node;
+        }
+    }
+    return 0;
+}
+
+template<typename KeyType, typename ValueType>
+const ValueType& PersistentMapSHPP<KeyType, ValueType>::Snapshot::get(const KeyType& key) const{
+    const BSTNode* node = findNode(key);
+    if (node == 0){
+        std::cout << "Error: key is not found in the map" << std::endl;
+        exit(1);
+    }
+    return node->Value;
+}
+
+template<typename KeyType, typename ValueType>
+bool PersistentMapSHPP<KeyType, ValueType>::Snapshot::containsKey(const KeyType& key) const{
+    return findNode(key) != 0;
+}
+
+template<typename KeyType, typename ValueType>
+int PersistentMapSHPP<KeyType, ValueType>::Snapshot::size() const{
+    return getNodeWeight(root);
+}
+
+template<typename KeyType, typename ValueType>
+bool PersistentMapSHPP<KeyType, ValueType>::Snapshot::isEmpty() const{
+    return !root;
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator PersistentMapSHPP<KeyType, ValueType>::Snapshot::begin() const{
+    iterator it(getNodeHeight(root));
+    it.pushLeftPath(root.get());
+    return it;
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator PersistentMapSHPP<KeyType, ValueType>::Snapshot::end() const{
+    return iterator();
+}
+
+/* Implementation of all methods of PersistentMapSHPP::Snapshot::iterator class*/
+template<typename KeyType, typename ValueType>
+PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::iterator(){
+    path = 0;
+    capacity = 0;
+    depth = 0;
+}
+
+template<typename KeyType, typename ValueType>
+PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::iterator(int height){
+    path = height > 0 ? new const BSTNode*[height] : 0;
+    capacity = height;
+    depth = 0;
+}
+
+template<typename KeyType, typename ValueType>
+PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::iterator(const iterator& src){
+    deepCopy(src);
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator& PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::operator =(const iterator& src){
+    if (this != &src){
+        delete[] path;
+        deepCopy(src);
+    }
+    return *this;
+}
+
+template<typename KeyType, typename ValueType>
+PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::~iterator(){
+    delete[] path;
+}
+
+template<typename KeyType, typename ValueType>
+void PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::deepCopy(const iterator& src){
+    capacity = src.capacity;
+    depth = src.depth;
+    path = capacity > 0 ? new const BSTNode*[capacity] : 0;
+    for (int i = 0; i < depth; i++){
+        path[i] = src.path[i];
+    }
+}
+
+template<typename KeyType, typename ValueType>
+void PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::pushLeftPath(const BSTNode* node){
+    while (node != 0){
+        path[depth++] = node;
+        node = node->left.get();
+    }
+}
+
+template<typename KeyType, typename ValueType>
+const KeyType& PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::key() const{
+    return path[depth - 1]->Key;
+}
+
+template<typename KeyType, typename ValueType>
+const ValueType& PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::value() const{
+    return path[depth - 1]->Value;
+}
+
+template<typename KeyType, typename ValueType>
+const KeyType& PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::operator *() const{
+    return path[depth - 1]->Key;
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator& PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::operator ++(){
+    const BSTNode* node = path[--depth];
+    pushLeftPath(node->right.get());
+    return *this;
+}
+
+template<typename KeyType, typename ValueType>
+typename PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::operator ++(int){
+    iterator previous = *this;
+    ++(*this);
+    return previous;
+}
+
+template<typename KeyType, typename ValueType>
+bool PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::operator ==(const iterator& other) const{
+    if (depth == 0 || other.depth == 0){
+        return depth == other.depth;
+    }
+    return path[depth - 1] == other.path[other.depth - 1];
+}
+
+template<typename KeyType, typename ValueType>
+bool PersistentMapSHPP<KeyType, ValueType>::Snapshot::iterator::operator !=(const iterator& other) const{
+    return !(*this == other);
+}
+
+#endif // PERSISTENTMAPSHPP_H
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <stdlib.h>
 #include "vectorshpp.h"
+#include "serializeshpp.h"
 
 /* Class: PQueueSHPP<ValueType> pqueue;
  * ---------------------------------------------------
@@ -83,6 +84,23 @@ public:
    */
     int size() const;
 
+    /* Method: save
+   * Usage: pqueue.save(out);
+   * --------------------------------------------
+   * Writes values and priorities of all elements to the
+   * binary stream in the order of the heap
+   */
+    void save(std::ostream& out) const;
+
+    /* Method: load
+   * Usage: pqueue.load(in);
+   * --------------------------------------------
+   * Replaces the content of the pqueue by the elements read
+   * from the binary stream written by save. The saved order
+   * is already a heap, so nothing is shifted
+   */
+    void load(std::istream& in);
+
     /* Operator: =
     * pqueueNew = pqueueOld;
     * -----------------------------------------------------
@@ -143,6 +161,14 @@ private:
      */
     void deepCopy(const PQueueSHPP<ValueType> & src);
 
+    /* Method: linkNodes;
+     * Usage: linkNodes();
+     * ------------------------------------------------
+     * Sets links between nodes according to their places
+     * in the array
+     */
+    void linkNodes();
+
 };
 
 /* Implementation of all methods of PQueueSHPP class*/
@@ -153,7 +179,7 @@ PQueueSHPP<ValueType>::PQueueSHPP() {
 
 template <typename ValueType>
 PQueueSHPP<ValueType>::~PQueueSHPP() {
-
+    clear();
 }
 
 template <typename ValueType>
@@ -218,7 +244,10 @@ double PQueueSHPP<ValueType>::peekPriority() {
 
 template <typename ValueType>
 void PQueueSHPP<ValueType>::clear() {
-    delete array;
+    for (int i = 0; i < heapSize; i++){
+        delete array[i];
+    }
+    array.clear();
     heapSize = 0;
 }
 
@@ -238,10 +267,14 @@ void PQueueSHPP<ValueType>::deepCopy(const PQueueSHPP<ValueType> & src){
         heapNode* newNode = new heapNode;
         newNode->priority = src.array[i]->priority;
         newNode->value = src.array[i]->value;
-        this->heapSize = src.heapSize;
         this->array.add(newNode);
     }
+    this->heapSize = src.heapSize;
+    linkNodes();
+}
 
+template<typename ValueType>
+void PQueueSHPP<ValueType>::linkNodes(){
     for(int i = 0; i < heapSize; i++){
 
         if (2 * i + 1 < array.size()){
@@ -266,15 +299,44 @@ void PQueueSHPP<ValueType>::deepCopy(const PQueueSHPP<ValueType> & src){
 
 template<typename ValueType>
 PQueueSHPP<ValueType>::PQueueSHPP(const PQueueSHPP<ValueType>& src){
+    heapSize = 0;
     deepCopy(src);
 }
 
 template<typename ValueType>
 PQueueSHPP<ValueType> & PQueueSHPP<ValueType>::operator =(const PQueueSHPP<ValueType>& src){
-    deepCopy(src);
+    if (this != &src){
+        clear();
+        deepCopy(src);
+    }
     return *this;
 }
 
+template<typename ValueType>
+void PQueueSHPP<ValueType>::save(std::ostream& out) const{
+    SerializeSHPP::writeHeader(out, SerializeSHPP::PQUEUE, 0, sizeof(ValueType), heapSize);
+    for (int i = 0; i < heapSize; i++){
+        SerializerSHPP<ValueType>::write(out, array[i]->value);
+        SerializerSHPP<double>::write(out, array[i]->priority);
+    }
+}
+
+template<typename ValueType>
+void PQueueSHPP<ValueType>::load(std::istream& in){
+    int n = SerializeSHPP::readHeader(in, SerializeSHPP::PQUEUE, 0, sizeof(ValueType));
+    clear();
+    array.reserve(n);
+    for (int i = 0; i < n; i++){
+        heapNode* newNode = new heapNode;
+        SerializerSHPP<ValueType>::read(in, newNode->value);
+        SerializerSHPP<double>::read(in, newNode->priority);
+        array.add(newNode);
+    }
+    SerializeSHPP::checkStream(in);
+    heapSize = n;
+    linkNodes();
+}
+
 template <typename ValueType>
 void PQueueSHPP<ValueType>::shiftUp(heapNode *node){
     if (node->top != 0){
@@ -1,18 +1,29 @@
 /* File: queueshpp.h
  * -----------------------------------------------------
  * This file exports a simple version of the Queue class
- * based on the linked list.
+ * based on the circular dynamic array.
  */
 
 #ifndef QUEUESHPP_H
 #define QUEUESHPP_H
 
 #include <iostream>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+#include <climits>
+#include <iterator>
+#include "serializeshpp.h"
+#include "vectorshpp.h"
 
 /* Class: QueueSHPP<ValueType>
  * ---------------------------------------------------
  * This clas implements queue of a specified ValueType
- * elements
+ * elements. Elements are kept in a circular array whose size is
+ * a power of two, so enqueue and dequeue do not allocate memory
+ * until the queue outgrows the array
  */
 template <typename ValueType>
 class QueueSHPP{
@@ -33,6 +44,13 @@ public:
      */
     virtual ~QueueSHPP();
 
+    /* Copy constructor and assignment operator
+     * ----------------------------------------------
+     * Copy all elements of the received queue
+     */
+    QueueSHPP(const QueueSHPP<ValueType>& src);
+    QueueSHPP<ValueType>& operator=(const QueueSHPP<ValueType>& src);
+
     /* Method: dequeue
      * Usage: value = queue.dequeue();
      * ---------------------------------------------
@@ -51,10 +69,28 @@ public:
     /* Method: clear
      * Usage: queue.clear();
      * ---------------------------------------------
-     * Removes all elements of the queue
+     * Removes all elements of the queue. The array
+     * is kept for the next elements
      */
     void clear();
 
+    /* Method: reserve
+     * Usage: queue.reserve(n);
+     * ---------------------------------------------
+     * Makes room for n elements, so the queue does not
+     * allocate memory until it holds more of them. Stops the
+     * program if n is above MAX_SIZE
+     */
+    void reserve(int n);
+
+    /* Method: capacity
+     * Usage: int capacity = queue.capacity();
+     * --------------------------------------------
+     * Returns number of the elements the queue holds
+     * without allocating memory
+     */
+    int capacity() const;
+
     /* Method: size
      * Usage: int size = queue.size();
      * --------------------------------------------
@@ -78,43 +114,165 @@ public:
      */
     ValueType peek() const;
 
+    /* Method: enqueueAll
+     * Usage: queue.enqueueAll(first, last);
+     * ---------------------------------------------
+     * Adds copies of the elements of [first, last) to the end
+     * of the queue, allocating memory at most once. Plain arrays
+     * of trivially copyable elements are copied by memcpy
+     */
+    template<typename Iterator>
+    void enqueueAll(Iterator first, Iterator last);
+
+    /* Method: dequeueBatch
+     * Usage: int n = queue.dequeueBatch(values, max);
+     * ---------------------------------------------
+     * Removes up to max first elements of the queue, moves them
+     * to values in the queue order and returns their number
+     */
+    int dequeueBatch(ValueType *values, int max);
+
+    /* Method: drainTo
+     * Usage: int n = queue.drainTo(vector);
+     *        int n = queue.drainTo(vector, max);
+     * ---------------------------------------------
+     * Removes up to max first elements of the queue, appends
+     * them to the vector in the queue order and returns their
+     * number. Without max the whole queue is drained
+     */
+    int drainTo(VectorSHPP<ValueType>& vector, int max = INT_MAX);
+
+    /* Method: save
+     * Usage: queue.save(out);
+     * -----------------------------------------------------
+     * Writes all elements from the first to the last to the
+     * binary stream
+     */
+    void save(std::ostream& out) const;
+
+    /* Method: load
+     * Usage: queue.load(in);
+     * -----------------------------------------------------
+     * Replaces the content of the queue by the elements read
+     * from the binary stream written by save
+     */
+    void load(std::istream& in);
+
     /* Private methods prototypes and instase variables*/
 private:
 
-    /* Structure for saving elements of the queue*/
-    struct Cell{
-        ValueType value;
-        Cell* link;
-    };
+    static const int START_SIZE = 16;
+
+    /* The largest power of two that fits into int*/
+    static const int MAX_SIZE = 1 << 30;
 
-    /* Links for the linked list*/
-    Cell* top;
-    Cell* down;
+    /* Circular array of raw memory, only count elements
+     * starting from head are constructed*/
+    ValueType *array;
+
+    /* Size of the array, always a power of two*/
+    int currentSize;
+
+    /* Index of the first element*/
+    int head;
 
     /* Current number of the elements in the queue*/
     int count;
 
+    /* Method: slot
+     * Usage: ValueType *place = slot(i);
+     * ------------------------------------------------
+     * Returns place of the i-th element from the head
+     */
+    ValueType *slot(int i) const;
+
+    /* Method: reallocate
+     * Usage: reallocate(newSize);
+     * ------------------------------------------------
+     * Moves elements to a new array of newSize elements,
+     * the first element goes to index 0
+     */
+    void reallocate(int newSize);
+
+    /* Method: relocate
+     * Usage: relocate(from, n, to);
+     * ------------------------------------------------
+     * Moves n elements to raw memory, leaving from raw
+     */
+    static void relocate(ValueType *from, int n, ValueType *to);
+
+    /* Method: firstPart
+     * Usage: int part = firstPart(n);
+     * ------------------------------------------------
+     * Returns how many of n elements starting from the head
+     * lie before the end of the array
+     */
+    int firstPart(int n) const;
+
+    /* Method: constructRange
+     * Usage: constructRange(first, n, to);
+     * ------------------------------------------------
+     * Copies n elements starting from first to the raw memory.
+     * Plain arrays of trivially copyable elements are copied
+     * by memcpy
+     */
+    template<typename Iterator>
+    static void constructRange(Iterator first, int n, ValueType *to);
+    static void constructRange(const ValueType *first, int n, ValueType *to);
+    static void constructRange(ValueType *first, int n, ValueType *to);
+
+    /* Method: moveOut
+     * Usage: moveOut(from, n, to);
+     * ------------------------------------------------
+     * Moves n elements to constructed elements of to and
+     * destroys the originals
+     */
+    static void moveOut(ValueType *from, int n, ValueType *to);
+
+    /* Method: deepCopy
+     * Usage: deepCopy(src);
+     * ------------------------------------------------
+     * Copies elements of src to the empty queue
+     */
+    void deepCopy(const QueueSHPP<ValueType>& src);
+
 };
 
 
 /* Implementation of all methods of QueueSHPP class*/
 template <typename ValueType>
 QueueSHPP<ValueType> :: QueueSHPP(){
+    array = static_cast<ValueType*>(::operator new(sizeof(ValueType) * START_SIZE));
+    currentSize = START_SIZE;
+    head = 0;
     count = 0;
-    top = down = NULL;
+}
+
+template<typename ValueType>
+QueueSHPP<ValueType> :: QueueSHPP(const QueueSHPP<ValueType>& src){
+    array = static_cast<ValueType*>(::operator new(sizeof(ValueType) * src.currentSize));
+    currentSize = src.currentSize;
+    head = 0;
+    count = 0;
+    deepCopy(src);
+}
+
+template<typename ValueType>
+QueueSHPP<ValueType>& QueueSHPP<ValueType> :: operator=(const QueueSHPP<ValueType>& src){
+    if (this != &src){
+        clear();
+        reserve(src.count);
+        deepCopy(src);
+    }
+    return *this;
 }
 
 template<typename ValueType>
 void QueueSHPP<ValueType> :: enqueue(ValueType newValue){
-    Cell *newCell = new Cell;
-    newCell->value = newValue;
-    newCell->link = NULL;
-    if(top == NULL) {
-        top = down = newCell;
-    } else {
-        down->link = newCell;
-        down  = newCell;
+    if (count == currentSize){
+        reserve(count + 1);
     }
+    new (slot(count)) ValueType(std::move(newValue));
     count++;
 }
 
@@ -124,24 +282,44 @@ ValueType QueueSHPP<ValueType> :: dequeue(){
       std:: cout << "Fatal error: queue is empty" << std:: endl;
         exit(1);
     }
-        Cell *tmpCell = top;
-        top = top->link;
-        ValueType tmpValue = tmpCell->value;
+        ValueType tmpValue(std::move(array[head]));
+        array[head].~ValueType();
+        head = (head + 1) & (currentSize - 1);
         count--;
-        delete tmpCell;
         return tmpValue;
 }
 
 template<typename ValueType>
 void QueueSHPP<ValueType> :: clear(){
-    for(int i = 0; i < count; i++){
-        Cell *tmpCell = top;
-        top = top->link;
-        delete tmpCell;
+    if (!std::is_trivially_destructible<ValueType>::value){
+        for(int i = 0; i < count; i++){
+            slot(i)->~ValueType();
+        }
     }
+    head = 0;
     count = 0;
 }
 
+template<typename ValueType>
+void QueueSHPP<ValueType> :: reserve(int n){
+    if (n > currentSize){
+        if (n > MAX_SIZE){
+            std::cout << "Fatal error: queue can not hold " << n << " elements" << std::endl;
+            exit(1);
+        }
+        int newSize = currentSize;
+        while (newSize < n){
+            newSize *= 2;
+        }
+        reallocate(newSize);
+    }
+}
+
+template<typename ValueType>
+int QueueSHPP<ValueType> :: capacity() const{
+    return currentSize;
+}
+
 template<typename ValueType>
 int QueueSHPP<ValueType> :: size() const{
     return count;
@@ -154,16 +332,182 @@ bool QueueSHPP<ValueType> :: isEmpty() const{
 
 template<typename ValueType>
 ValueType QueueSHPP<ValueType> :: peek() const{
-    return top->value;
+    if (count == 0){
+      std:: cout << "Fatal error: queue is empty" << std:: endl;
+        exit(1);
+    }
+    return array[head];
+}
+
+template<typename ValueType>
+template<typename Iterator>
+void QueueSHPP<ValueType> :: enqueueAll(Iterator first, Iterator last){
+    int n = (int)std::distance(first, last);
+    if (n > MAX_SIZE - count){
+        std::cout << "Fatal error: queue can not hold " << (long long)count + n << " elements" << std::endl;
+        exit(1);
+    }
+    reserve(count + n);
+    /* The tail of the ring is free up to the array end, then from its start*/
+    int tail = (head + count) & (currentSize - 1);
+    int part = n < currentSize - tail ? n : currentSize - tail;
+    constructRange(first, part, array + tail);
+    std::advance(first, part);
+    constructRange(first, n - part, array);
+    count += n;
+}
+
+template<typename ValueType>
+int QueueSHPP<ValueType> :: dequeueBatch(ValueType *values, int max){
+    int n = max < count ? max : count;
+    if (n <= 0){
+        return 0;
+    }
+    int part = firstPart(n);
+    moveOut(array + head, part, values);
+    moveOut(array, n - part, values + part);
+    head = (head + n) & (currentSize - 1);
+    count -= n;
+    return n;
+}
+
+template<typename ValueType>
+int QueueSHPP<ValueType> :: drainTo(VectorSHPP<ValueType>& vector, int max){
+    int n = max < count ? max : count;
+    if (n <= 0){
+        return 0;
+    }
+    int part = firstPart(n);
+    vector.reserve(vector.size() + n);
+    if (std::is_trivially_copyable<ValueType>::value){
+        vector.insertRange(vector.size(), array + head, array + head + part);
+        vector.insertRange(vector.size(), array, array + n - part);
+    } else {
+        vector.insertRange(vector.size(), std::make_move_iterator(array + head), std::make_move_iterator(array + head + part));
+        vector.insertRange(vector.size(), std::make_move_iterator(array), std::make_move_iterator(array + n - part));
+        for (int i = 0; i < n; i++){
+            slot(i)->~ValueType();
+        }
+    }
+    head = (head + n) & (currentSize - 1);
+    count -= n;
+    return n;
+}
+
+template<typename ValueType>
+int QueueSHPP<ValueType> :: firstPart(int n) const{
+    return n < currentSize - head ? n : currentSize - head;
+}
+
+template<typename ValueType>
+template<typename Iterator>
+void QueueSHPP<ValueType> :: constructRange(Iterator first, int n, ValueType *to){
+    for (int i = 0; i < n; i++, ++first){
+        new (to + i) ValueType(*first);
+    }
+}
+
+template<typename ValueType>
+void QueueSHPP<ValueType> :: constructRange(const ValueType *first, int n, ValueType *to){
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (n > 0){
+            memcpy(static_cast<void*>(to), static_cast<const void*>(first), sizeof(ValueType) * n);
+        }
+    } else {
+        for (int i = 0; i < n; i++){
+            new (to + i) ValueType(first[i]);
+        }
+    }
+}
+
+template<typename ValueType>
+void QueueSHPP<ValueType> :: constructRange(ValueType *first, int n, ValueType *to){
+    constructRange(static_cast<const ValueType*>(first), n, to);
+}
+
+template<typename ValueType>
+void QueueSHPP<ValueType> :: moveOut(ValueType *from, int n, ValueType *to){
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (n > 0){
+            memcpy(static_cast<void*>(to), static_cast<const void*>(from), sizeof(ValueType) * n);
+        }
+    } else {
+        for (int i = 0; i < n; i++){
+            to[i] = std::move(from[i]);
+            from[i].~ValueType();
+        }
+    }
+}
+
+template<typename ValueType>
+ValueType *QueueSHPP<ValueType> :: slot(int i) const{
+    return array + ((head + i) & (currentSize - 1));
+}
+
+template<typename ValueType>
+void QueueSHPP<ValueType> :: reallocate(int newSize){
+    ValueType *newArray = static_cast<ValueType*>(::operator new(sizeof(ValueType) * newSize));
+    int part = firstPart(count);
+    relocate(array + head, part, newArray);
+    relocate(array, count - part, newArray + part);
+    ::operator delete(array);
+    array = newArray;
+    currentSize = newSize;
+    head = 0;
+}
+
+template<typename ValueType>
+void QueueSHPP<ValueType> :: relocate(ValueType *from, int n, ValueType *to){
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (n > 0){
+            memcpy(static_cast<void*>(to), static_cast<const void*>(from), sizeof(ValueType) * n);
+        }
+    } else {
+        for (int i = 0; i < n; i++){
+            new (to + i) ValueType(std::move(from[i]));
+            from[i].~ValueType();
+        }
+    }
+}
+
+template<typename ValueType>
+void QueueSHPP<ValueType> :: deepCopy(const QueueSHPP<ValueType>& src){
+    for (int i = 0; i < src.count; i++){
+        new (array + i) ValueType(*src.slot(i));
+    }
+    head = 0;
+    count = src.count;
+}
+
+template<typename ValueType>
+void QueueSHPP<ValueType> :: save(std::ostream& out) const{
+    SerializeSHPP::writeHeader(out, SerializeSHPP::QUEUE, 0, sizeof(ValueType), count);
+    int part = firstPart(count);
+    SerializerSHPP<ValueType>::writeArray(out, array + head, part);
+    SerializerSHPP<ValueType>::writeArray(out, array, count - part);
+}
+
+template<typename ValueType>
+void QueueSHPP<ValueType> :: load(std::istream& in){
+    int n = SerializeSHPP::readHeader(in, SerializeSHPP::QUEUE, 0, sizeof(ValueType));
+    clear();
+    reserve(n);
+    if (std::is_trivially_copyable<ValueType>::value){
+        SerializerSHPP<ValueType>::readArray(in, array, n);
+        count = n;
+    } else {
+        for (int i = 0; i < n; i++){
+            ValueType value;
+            SerializerSHPP<ValueType>::read(in, value);
+            enqueue(value);
+        }
+    }
+    SerializeSHPP::checkStream(in);
 }
 
 template <typename ValueType>
 QueueSHPP<ValueType> :: ~QueueSHPP(){
-    for(int i = 0; i < count; i++){
-        Cell *tmpCell = top;
-        top = top->link;
-        delete tmpCell;
-    }
+    clear();
+    ::operator delete(array);
 }
 #endif // QUEUESHPP
-
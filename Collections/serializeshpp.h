@@ -0,0 +1,256 @@
+/* File: serializeshpp.h
+ * -----------------------------------
+ *
+ * This file exports the binary format used by
+ * save and load methods of the SHPP collections
+ * and a stream that reads from a memory buffer.
+ */
+
+#ifndef SERIALIZESHPP_H
+#define SERIALIZESHPP_H
+
+#include <iostream>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <type_traits>
+
+/* Layout of the saved collection:
+ *   "SHPB"              4 bytes of magic
+ *   version             uint16_t, SerializeSHPP::VERSION
+ *   kind                uint16_t, type of the collection
+ *   keySize, valueSize  uint32_t, sizeof of the key (0 if there is
+ *                       no key) and of the value type
+ *   count               int64_t, number of the elements
+ * followed by the elements. Numbers are written in the byte order
+ * of the machine, so files move only between machines with the
+ * same byte order.
+ */
+
+/* Struct: SerializerSHPP
+ * --------------------------------
+ * Writes and reads one element type. Trivially copyable types are
+ * copied as bytes, arrays of them by one write or read. Specialize
+ * this struct to save other types, as it is done for std::string
+ */
+template<typename ValueType, bool Bytes = std::is_trivially_copyable<ValueType>::value>
+struct SerializerSHPP{
+
+    static_assert(Bytes, "Specialize SerializerSHPP to save this type");
+
+    static void write(std::ostream& out, const ValueType& value){
+        out.write(reinterpret_cast<const char*>(&value), sizeof(ValueType));
+    }
+
+    static void read(std::istream& in, ValueType& value){
+        in.read(reinterpret_cast<char*>(&value), sizeof(ValueType));
+    }
+
+    /* Arrays are written in one call. read may receive raw
+     * memory, because the elements are trivially copyable*/
+    static void writeArray(std::ostream& out, const ValueType *array, int n){
+        out.write(reinterpret_cast<const char*>(array), (std::streamsize)sizeof(ValueType) * n);
+    }
+
+    static void readArray(std::istream& in, ValueType *array, int n){
+        in.read(reinterpret_cast<char*>(array), (std::streamsize)sizeof(ValueType) * n);
+    }
+};
+
+/* Strings are saved as the length followed by the characters*/
+template<>
+struct SerializerSHPP<std::string, false>{
+
+    static void write(std::ostream& out, const std::string& value){
+        int64_t length = (int64_t)value.size();
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(value.data(), (std::streamsize)length);
+    }
+
+    static void read(std::istream& in, std::string& value){
+        int64_t length = 0;
+        in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        if (!in || length < 0){
+            std::cout << "Error: saved data is damaged" << std::endl;
+            exit(1);
+        }
+        value.resize((size_t)length);
+        if (length > 0){
+            in.read(&value[0], (std::streamsize)length);
+        }
+    }
+
+    static void writeArray(std::ostream& out, const std::string *array, int n){
+        for (int i = 0; i < n; i++){
+            write(out, array[i]);
+        }
+    }
+
+    static void readArray(std::istream& in, std::string *array, int n){
+        for (int i = 0; i < n; i++){
+            read(in, array[i]);
+        }
+    }
+};
+
+
+/* Class: SerializeSHPP
+ * --------------------------------
+ * Common part of the format: the header of the saved collection
+ * and the check of the stream after reading
+ */
+class SerializeSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Version of the format, increased when the layout changes*/
+    static const uint16_t VERSION = 1;
+
+    /* Types of the saved collections. MapSHPP and BTreeMapSHPP
+     * share the layout: pairs of key and value in ascending order*/
+    enum Kind {
+        VECTOR = 1,
+        STACK = 2,
+        QUEUE = 3,
+        DEQUE = 4,
+        PQUEUE = 5,
+        SORTED_MAP = 6,
+        HASH_MAP = 7
+    };
+
+    /* Method: writeHeader
+     * Usage: SerializeSHPP::writeHeader(out, SerializeSHPP::VECTOR, 0, sizeof(ValueType), count);
+     * -----------------------------------------------------
+     * Writes the header of the collection to the stream
+     */
+    static void writeHeader(std::ostream& out, Kind kind, uint32_t keySize, uint32_t valueSize, int count){
+        char header[HEADER_BYTES];
+        uint16_t version = VERSION;
+        uint16_t kindCode = (uint16_t)kind;
+        int64_t count64 = count;
+        memcpy(header, "SHPB", 4);
+        memcpy(header + 4, &version, 2);
+        memcpy(header + 6, &kindCode, 2);
+        memcpy(header + 8, &keySize, 4);
+        memcpy(header + 12, &valueSize, 4);
+        memcpy(header + 16, &count64, 8);
+        out.write(header, HEADER_BYTES);
+    }
+
+    /* Method: readHeader
+     * Usage: int count = SerializeSHPP::readHeader(in, SerializeSHPP::VECTOR, 0, sizeof(ValueType));
+     * -----------------------------------------------------
+     * Reads the header, checks that it describes the same kind
+     * of collection with the same element sizes and returns
+     * the number of the elements
+     */
+    static int readHeader(std::istream& in, Kind kind, uint32_t keySize, uint32_t valueSize){
+        char header[HEADER_BYTES];
+        in.read(header, HEADER_BYTES);
+        uint16_t version;
+        uint16_t kindCode;
+        uint32_t savedKeySize;
+        uint32_t savedValueSize;
+        int64_t count;
+        memcpy(&version, header + 4, 2);
+        memcpy(&kindCode, header + 6, 2);
+        memcpy(&savedKeySize, header + 8, 4);
+        memcpy(&savedValueSize, header + 12, 4);
+        memcpy(&count, header + 16, 8);
+        if (!in || memcmp(header, "SHPB", 4) != 0 || version != VERSION){
+            std::cout << "Error: saved data is damaged" << std::endl;
+            exit(1);
+        }
+        if (kindCode != kind || savedKeySize != keySize || savedValueSize != valueSize){
+            std::cout << "Error: saved data holds another collection" << std::endl;
+            exit(1);
+        }
+        if (count < 0 || count > 0x7fffffff){
+            std::cout << "Error: saved data is damaged" << std::endl;
+            exit(1);
+        }
+        return (int)count;
+    }
+
+    /* Method: checkStream
+     * Usage: SerializeSHPP::checkStream(in);
+     * -----------------------------------------------------
+     * Stops the program if the last reads ran out of data
+     */
+    static void checkStream(std::istream& in){
+        if (!in){
+            std::cout << "Error: saved data is damaged" << std::endl;
+            exit(1);
+        }
+    }
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Size of the header in bytes*/
+    static const int HEADER_BYTES = 24;
+};
+
+
+/* Class: MemoryStreamSHPP
+ * --------------------------------
+ * Input stream over the received memory, for example over a
+ * mapped file. Reading arrays of trivially copyable elements
+ * is a plain memcpy from the buffer. The memory is not copied
+ * and must outlive the stream
+ */
+class MemoryStreamSHPP : public std::istream{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: MemoryStreamSHPP
+     * Usage: MemoryStreamSHPP in(data, size);
+     * -----------------------------------------------------
+     * Initializes a new stream that reads size bytes from data
+     */
+    MemoryStreamSHPP(const void *data, size_t size) : std::istream(0), buffer(data, size){
+        rdbuf(&buffer);
+    }
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Stream buffer that reads the memory directly*/
+    class Buffer : public std::streambuf{
+    public:
+        Buffer(const void *data, size_t size){
+            char *begin = const_cast<char*>(static_cast<const char*>(data));
+            setg(begin, begin, begin + size);
+        }
+
+    protected:
+        std::streamsize xsgetn(char *to, std::streamsize n){
+            std::streamsize available = egptr() - gptr();
+            if (n > available){
+                n = available;
+            }
+            memcpy(to, gptr(), (size_t)n);
+            /* gbump moves by int, big arrays need several steps*/
+            for (std::streamsize left = n; left > 0; ){
+                int step = left > 0x7fffffff ? 0x7fffffff : (int)left;
+                gbump(step);
+                left -= step;
+            }
+            return n;
+        }
+    };
+
+    /* Forbid copying, the stream links to its own buffer*/
+    MemoryStreamSHPP(const MemoryStreamSHPP& src);
+    MemoryStreamSHPP& operator=(const MemoryStreamSHPP& src);
+
+    Buffer buffer;
+};
+
+#endif // SERIALIZESHPP_H
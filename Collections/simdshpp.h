@@ -0,0 +1,539 @@
+/* File: simdshpp.h
+ * -----------------------------------
+ *
+ * This file exports search and reduction functions
+ * for VectorSHPP and SpanSHPP that use SIMD
+ * instructions for int, float and double elements.
+ */
+
+#ifndef SIMDSHPP_H
+#define SIMDSHPP_H
+
+#include <iostream>
+#include <stdlib.h>
+#include <type_traits>
+#include "vectorshpp.h"
+#include "spanshpp.h"
+
+/* The instruction set is chosen at compile time: AVX2 if the
+ * compiler targets it (for example -mavx2 or -march=native),
+ * otherwise SSE2, which every x86-64 compiler enables. Other
+ * processors and other element types use plain loops.
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMDSHPP_SSE2
+#endif
+
+
+/* Struct: SimdSumSHPP
+ * --------------------------------
+ * Type of the sum of the elements. Integers are summed in
+ * 64 bits, so the sum of a big vector of int does not overflow
+ */
+template<typename ValueType, bool Integral = std::is_integral<ValueType>::value>
+struct SimdSumSHPP{
+    typedef ValueType type;
+};
+
+template<typename ValueType>
+struct SimdSumSHPP<ValueType, true>{
+    typedef typename std::conditional<std::is_signed<ValueType>::value, long long, unsigned long long>::type type;
+};
+
+
+/* Struct: SimdOpsSHPP
+ * --------------------------------
+ * Operations with SIMD registers of the received element type.
+ * The general template has no registers, so the kernels fall
+ * back to plain loops. Every specialization defines:
+ *   Reg, SumReg        registers of elements and of partial sums
+ *   WIDTH              number of elements in Reg
+ *   load, broadcast    read WIDTH elements or fill with one value
+ *   equalMask          bit i is set if lane i of a equals lane i of b
+ *   min, max           lane wise minimum and maximum
+ *   reduceMin/Max/Sum  combine all lanes into one value
+ */
+template<typename ValueType>
+struct SimdOpsSHPP{
+    static const bool ENABLED = false;
+};
+
+#if defined(__AVX2__)
+
+template<>
+struct SimdOpsSHPP<int>{
+    static const bool ENABLED = true;
+    static const int WIDTH = 8;
+    typedef __m256i Reg;
+    typedef __m256i SumReg;
+    static Reg load(const int *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static Reg broadcast(int value) { return _mm256_set1_epi32(value); }
+    static int equalMask(Reg a, Reg b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+    static SumReg sumZero() { return _mm256_setzero_si256(); }
+    static SumReg addToSum(SumReg sum, Reg a){
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(a)));
+        return _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(a, 1)));
+    }
+    static int reduceMin(Reg a){
+        int lanes[WIDTH];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), a);
+        int result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (lanes[i] < result) result = lanes[i];
+        return result;
+    }
+    static int reduceMax(Reg a){
+        int lanes[WIDTH];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), a);
+        int result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (result < lanes[i]) result = lanes[i];
+        return result;
+    }
+    static long long reduceSum(SumReg sum){
+        long long lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+};
+
+template<>
+struct SimdOpsSHPP<float>{
+    static const bool ENABLED = true;
+    static const int WIDTH = 8;
+    typedef __m256 Reg;
+    typedef __m256 SumReg;
+    static Reg load(const float *p) { return _mm256_loadu_ps(p); }
+    static Reg broadcast(float value) { return _mm256_set1_ps(value); }
+    static int equalMask(Reg a, Reg b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+    static SumReg sumZero() { return _mm256_setzero_ps(); }
+    static SumReg addToSum(SumReg sum, Reg a) { return _mm256_add_ps(sum, a); }
+    static float reduceMin(Reg a){
+        float lanes[WIDTH];
+        _mm256_storeu_ps(lanes, a);
+        float result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (lanes[i] < result) result = lanes[i];
+        return result;
+    }
+    static float reduceMax(Reg a){
+        float lanes[WIDTH];
+        _mm256_storeu_ps(lanes, a);
+        float result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (result < lanes[i]) result = lanes[i];
+        return result;
+    }
+    static float reduceSum(SumReg sum){
+        float lanes[WIDTH];
+        _mm256_storeu_ps(lanes, sum);
+        float result = 0;
+        for (int i = 0; i < WIDTH; i++) result += lanes[i];
+        return result;
+    }
+};
+
+template<>
+struct SimdOpsSHPP<double>{
+    static const bool ENABLED = true;
+    static const int WIDTH = 4;
+    typedef __m256d Reg;
+    typedef __m256d SumReg;
+    static Reg load(const double *p) { return _mm256_loadu_pd(p); }
+    static Reg broadcast(double value) { return _mm256_set1_pd(value); }
+    static int equalMask(Reg a, Reg b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+    static SumReg sumZero() { return _mm256_setzero_pd(); }
+    static SumReg addToSum(SumReg sum, Reg a) { return _mm256_add_pd(sum, a); }
+    static double reduceMin(Reg a){
+        double lanes[WIDTH];
+        _mm256_storeu_pd(lanes, a);
+        double result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (lanes[i] < result) result = lanes[i];
+        return result;
+    }
+    static double reduceMax(Reg a){
+        double lanes[WIDTH];
+        _mm256_storeu_pd(lanes, a);
+        double result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (result < lanes[i]) result = lanes[i];
+        return result;
+    }
+    static double reduceSum(SumReg sum){
+        double lanes[WIDTH];
+        _mm256_storeu_pd(lanes, sum);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+};
+
+#elif defined(SIMDSHPP_SSE2)
+
+template<>
+struct SimdOpsSHPP<int>{
+    static const bool ENABLED = true;
+    static const int WIDTH = 4;
+    typedef __m128i Reg;
+    typedef __m128i SumReg;
+    static Reg load(const int *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static Reg broadcast(int value) { return _mm_set1_epi32(value); }
+    static int equalMask(Reg a, Reg b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+    /* SSE2 has no min and max of 32 bit integers, select by comparison*/
+    static Reg min(Reg a, Reg b){
+        Reg less = _mm_cmplt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(less, a), _mm_andnot_si128(less, b));
+    }
+    static Reg max(Reg a, Reg b){
+        Reg greater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+    }
+    static SumReg sumZero() { return _mm_setzero_si128(); }
+    /* Sign extension to 64 bits: interleave elements with their sign masks*/
+    static SumReg addToSum(SumReg sum, Reg a){
+        Reg sign = _mm_srai_epi32(a, 31);
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(a, sign));
+        return _mm_add_epi64(sum, _mm_unpackhi_epi32(a, sign));
+    }
+    static int reduceMin(Reg a){
+        int lanes[WIDTH];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), a);
+        int result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (lanes[i] < result) result = lanes[i];
+        return result;
+    }
+    static int reduceMax(Reg a){
+        int lanes[WIDTH];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), a);
+        int result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (result < lanes[i]) result = lanes[i];
+        return result;
+    }
+    static long long reduceSum(SumReg sum){
+        long long lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+        return lanes[0] + lanes[1];
+    }
+};
+
+template<>
+struct SimdOpsSHPP<float>{
+    static const bool ENABLED = true;
+    static const int WIDTH = 4;
+    typedef __m128 Reg;
+    typedef __m128 SumReg;
+    static Reg load(const float *p) { return _mm_loadu_ps(p); }
+    static Reg broadcast(float value) { return _mm_set1_ps(value); }
+    static int equalMask(Reg a, Reg b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+    static Reg min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+    static SumReg sumZero() { return _mm_setzero_ps(); }
+    static SumReg addToSum(SumReg sum, Reg a) { return _mm_add_ps(sum, a); }
+    static float reduceMin(Reg a){
+        float lanes[WIDTH];
+        _mm_storeu_ps(lanes, a);
+        float result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (lanes[i] < result) result = lanes[i];
+        return result;
+    }
+    static float reduceMax(Reg a){
+        float lanes[WIDTH];
+        _mm_storeu_ps(lanes, a);
+        float result = lanes[0];
+        for (int i = 1; i < WIDTH; i++) if (result < lanes[i]) result = lanes[i];
+        return result;
+    }
+    static float reduceSum(SumReg sum){
+        float lanes[WIDTH];
+        _mm_storeu_ps(lanes, sum);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+};
+
+template<>
+struct SimdOpsSHPP<double>{
+    static const bool ENABLED = true;
+    static const int WIDTH = 2;
+    typedef __m128d Reg;
+    typedef __m128d SumReg;
+    static Reg load(const double *p) { return _mm_loadu_pd(p); }
+    static Reg broadcast(double value) { return _mm_set1_pd(value); }
+    static int equalMask(Reg a, Reg b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+    static Reg min(Reg a, Reg b) { return _mm_min_pd(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm_max_pd(a, b); }
+    static SumReg sumZero() { return _mm_setzero_pd(); }
+    static SumReg addToSum(SumReg sum, Reg a) { return _mm_add_pd(sum, a); }
+    static double reduceMin(Reg a){
+        double lanes[WIDTH];
+        _mm_storeu_pd(lanes, a);
+        return lanes[1] < lanes[0] ? lanes[1] : lanes[0];
+    }
+    static double reduceMax(Reg a){
+        double lanes[WIDTH];
+        _mm_storeu_pd(lanes, a);
+        return lanes[0] < lanes[1] ? lanes[1] : lanes[0];
+    }
+    static double reduceSum(SumReg sum){
+        double lanes[WIDTH];
+        _mm_storeu_pd(lanes, sum);
+        return lanes[0] + lanes[1];
+    }
+};
+
+#endif
+
+
+/* Struct: SimdKernelsSHPP
+ * --------------------------------
+ * Search and reduction over n contiguous elements. This general
+ * version uses plain loops and works for any type with ==, <
+ * and +. The specialization below processes WIDTH elements at
+ * once and finishes the tail with the plain loops
+ */
+template<typename ValueType, bool Simd = SimdOpsSHPP<ValueType>::ENABLED>
+struct SimdKernelsSHPP{
+
+    typedef typename SimdSumSHPP<ValueType>::type SumType;
+
+    static int find(const ValueType *array, int n, const ValueType& value){
+        for (int i = 0; i < n; i++){
+            if (array[i] == value){
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    static int count(const ValueType *array, int n, const ValueType& value){
+        int result = 0;
+        for (int i = 0; i < n; i++){
+            if (array[i] == value){
+                result++;
+            }
+        }
+        return result;
+    }
+
+    static ValueType minElement(const ValueType *array, int n){
+        ValueType result = array[0];
+        for (int i = 1; i < n; i++){
+            if (array[i] < result){
+                result = array[i];
+            }
+        }
+        return result;
+    }
+
+    static ValueType maxElement(const ValueType *array, int n){
+        ValueType result = array[0];
+        for (int i = 1; i < n; i++){
+            if (result < array[i]){
+                result = array[i];
+            }
+        }
+        return result;
+    }
+
+    static SumType sum(const ValueType *array, int n){
+        SumType result = SumType();
+        for (int i = 0; i < n; i++){
+            result += array[i];
+        }
+        return result;
+    }
+};
+
+template<typename ValueType>
+struct SimdKernelsSHPP<ValueType, true>{
+
+    typedef SimdOpsSHPP<ValueType> Ops;
+    typedef typename Ops::Reg Reg;
+    typedef SimdKernelsSHPP<ValueType, false> Scalar;
+    typedef typename SimdSumSHPP<ValueType>::type SumType;
+
+    static int find(const ValueType *array, int n, const ValueType& value){
+        Reg needle = Ops::broadcast(value);
+        int i = 0;
+        for (; i + Ops::WIDTH <= n; i += Ops::WIDTH){
+            int mask = Ops::equalMask(Ops::load(array + i), needle);
+            if (mask != 0){
+                int lane = 0;
+                while (!(mask & 1)){
+                    mask >>= 1;
+                    lane++;
+                }
+                return i + lane;
+            }
+        }
+        int tail = Scalar::find(array + i, n - i, value);
+        return tail < 0 ? -1 : i + tail;
+    }
+
+    static int count(const ValueType *array, int n, const ValueType& value){
+        Reg needle = Ops::broadcast(value);
+        int result = 0;
+        int i = 0;
+        for (; i + Ops::WIDTH <= n; i += Ops::WIDTH){
+            for (int mask = Ops::equalMask(Ops::load(array + i), needle); mask != 0; mask &= mask - 1){
+                result++;
+            }
+        }
+        return result + Scalar::count(array + i, n - i, value);
+    }
+
+    static ValueType minElement(const ValueType *array, int n){
+        if (n < Ops::WIDTH){
+            return Scalar::minElement(array, n);
+        }
+        Reg result = Ops::load(array);
+        int i = Ops::WIDTH;
+        for (; i + Ops::WIDTH <= n; i += Ops::WIDTH){
+            result = Ops::min(result, Ops::load(array + i));
+        }
+        ValueType best = Ops::reduceMin(result);
+        for (; i < n; i++){
+            if (array[i] < best){
+                best = array[i];
+            }
+        }
+        return best;
+    }
+
+    static ValueType maxElement(const ValueType *array, int n){
+        if (n < Ops::WIDTH){
+            return Scalar::maxElement(array, n);
+        }
+        Reg result = Ops::load(array);
+        int i = Ops::WIDTH;
+        for (; i + Ops::WIDTH <= n; i += Ops::WIDTH){
+            result = Ops::max(result, Ops::load(array + i));
+        }
+        ValueType best = Ops::reduceMax(result);
+        for (; i < n; i++){
+            if (best < array[i]){
+                best = array[i];
+            }
+        }
+        return best;
+    }
+
+    static SumType sum(const ValueType *array, int n){
+        typename Ops::SumReg result = Ops::sumZero();
+        int i = 0;
+        for (; i + Ops::WIDTH <= n; i += Ops::WIDTH){
+            result = Ops::addToSum(result, Ops::load(array + i));
+        }
+        return Ops::reduceSum(result) + Scalar::sum(array + i, n - i);
+    }
+};
+
+
+/* Function: find
+ * Usage: int index = find(vector, value);
+ * -----------------------------------------------------
+ * Returns index of the first element equal to value,
+ * or -1 if there is no such element
+ */
+template<typename ValueType>
+int find(const VectorSHPP<ValueType>& vector, const typename std::remove_const<ValueType>::type& value){
+    return SimdKernelsSHPP<ValueType>::find(vector.data(), vector.size(), value);
+}
+
+template<typename ValueType>
+int find(SpanSHPP<ValueType> span, const typename std::remove_const<ValueType>::type& value){
+    return SimdKernelsSHPP<typename std::remove_const<ValueType>::type>::find(span.data(), span.size(), value);
+}
+
+/* Function: count
+ * Usage: int n = count(vector, value);
+ * -----------------------------------------------------
+ * Returns the number of elements equal to value
+ */
+template<typename ValueType>
+int count(const VectorSHPP<ValueType>& vector, const typename std::remove_const<ValueType>::type& value){
+    return SimdKernelsSHPP<ValueType>::count(vector.data(), vector.size(), value);
+}
+
+template<typename ValueType>
+int count(SpanSHPP<ValueType> span, const typename std::remove_const<ValueType>::type& value){
+    return SimdKernelsSHPP<typename std::remove_const<ValueType>::type>::count(span.data(), span.size(), value);
+}
+
+/* Function: contains
+ * Usage: if (contains(vector, value))
+ * -----------------------------------------------------
+ * Returns true if some element is equal to value
+ */
+template<typename ValueType>
+bool contains(const VectorSHPP<ValueType>& vector, const typename std::remove_const<ValueType>::type& value){
+    return find(vector, value) >= 0;
+}
+
+template<typename ValueType>
+bool contains(SpanSHPP<ValueType> span, const typename std::remove_const<ValueType>::type& value){
+    return find(span, value) >= 0;
+}
+
+/* Function: minElement
+ * Usage: value = minElement(vector);
+ * -----------------------------------------------------
+ * Returns the smallest element. The vector must not be
+ * empty. Result for floating point elements with NaN is
+ * not specified
+ */
+template<typename ValueType>
+ValueType minElement(const VectorSHPP<ValueType>& vector){
+    return minElement(vector.view());
+}
+
+template<typename ValueType>
+typename std::remove_const<ValueType>::type minElement(SpanSHPP<ValueType> span){
+    if (span.isEmpty()){
+        std::cout << "Error: Vector is empty" << std::endl;
+        exit(1);
+    }
+    return SimdKernelsSHPP<typename std::remove_const<ValueType>::type>::minElement(span.data(), span.size());
+}
+
+/* Function: maxElement
+ * Usage: value = maxElement(vector);
+ * -----------------------------------------------------
+ * Returns the biggest element. The vector must not be
+ * empty. Result for floating point elements with NaN is
+ * not specified
+ */
+template<typename ValueType>
+ValueType maxElement(const VectorSHPP<ValueType>& vector){
+    return maxElement(vector.view());
+}
+
+template<typename ValueType>
+typename std::remove_const<ValueType>::type maxElement(SpanSHPP<ValueType> span){
+    if (span.isEmpty()){
+        std::cout << "Error: Vector is empty" << std::endl;
+        exit(1);
+    }
+    return SimdKernelsSHPP<typename std::remove_const<ValueType>::type>::maxElement(span.data(), span.size());
+}
+
+/* Function: sum
+ * Usage: total = sum(vector);
+ * -----------------------------------------------------
+ * Returns the sum of all elements, integers are summed in
+ * 64 bits. Floating point elements are added in several
+ * lanes at once, so the rounding may differ from a plain
+ * loop in the last bits
+ */
+template<typename ValueType>
+typename SimdSumSHPP<ValueType>::type sum(const VectorSHPP<ValueType>& vector){
+    return SimdKernelsSHPP<ValueType>::sum(vector.data(), vector.size());
+}
+
+template<typename ValueType>
+typename SimdSumSHPP<typename std::remove_const<ValueType>::type>::type sum(SpanSHPP<ValueType> span){
+    return SimdKernelsSHPP<typename std::remove_const<ValueType>::type>::sum(span.data(), span.size());
+}
+
+#endif // SIMDSHPP_H
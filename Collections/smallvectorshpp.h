@@ -0,0 +1,104 @@
+/* File: smallvectorshpp.h
+ * -----------------------------------
+ *
+ * This file exports a vector that keeps a few
+ * elements right inside the object.
+ */
+
+#ifndef SMALLVECTORSHPP_H
+#define SMALLVECTORSHPP_H
+
+#include <type_traits>
+#include <utility>
+#include "vectorshpp.h"
+
+/* Class SmallVectorSHPP<ValueType, InlineSize>
+ * --------------------------------
+ * This class implements a vector of a specified value type that
+ * stores up to InlineSize elements in its own buffer and uses
+ * the heap only when it grows bigger. It has the same methods
+ * as VectorSHPP and may be passed wherever VectorSHPP is expected.
+ */
+template<typename ValueType, int InlineSize>
+class SmallVectorSHPP : public VectorSHPP<ValueType>{
+
+    static_assert(InlineSize > 0, "SmallVectorSHPP needs place for at least one element");
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: SmallVectorSHPP
+     * Usage: SmallVectorSHPP<ValueType, 8> vector;
+     * -----------------------------------------------------
+     * Initializes a new empty vector in the inline buffer
+     */
+    SmallVectorSHPP();
+
+    /* Destructor: ~SmallVectorSHPP
+     * -----------------------------------------------------
+     * Destroys elements while the inline buffer is still alive
+     */
+    virtual ~SmallVectorSHPP();
+
+    /* Copy constructor*/
+    SmallVectorSHPP(const SmallVectorSHPP<ValueType, InlineSize> & src);
+
+    /* Move constructor, elements of the inline buffer are moved one by one*/
+    SmallVectorSHPP(SmallVectorSHPP<ValueType, InlineSize> && src);
+
+    /* Operator: =
+     * vectorNew = vectorOld;
+     * -----------------------------------------------------
+     * Overloads assign operator
+     */
+    SmallVectorSHPP<ValueType, InlineSize> & operator=(const SmallVectorSHPP<ValueType, InlineSize> & src);
+
+    /* Operator: =
+     * vectorNew = std::move(vectorOld);
+     * -----------------------------------------------------
+     * Takes the heap array of src or moves elements of its
+     * inline buffer, leaves src empty
+     */
+    SmallVectorSHPP<ValueType, InlineSize> & operator=(SmallVectorSHPP<ValueType, InlineSize> && src);
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Raw memory for the inline elements*/
+    typename std::aligned_storage<sizeof(ValueType), alignof(ValueType)>::type storage[InlineSize];
+};
+
+/* Implementation of all methods of SmallVectorSHPP class*/
+
+template<typename ValueType, int InlineSize>
+SmallVectorSHPP<ValueType, InlineSize>::SmallVectorSHPP() : VectorSHPP<ValueType>(reinterpret_cast<ValueType*>(storage), InlineSize){
+}
+
+template<typename ValueType, int InlineSize>
+SmallVectorSHPP<ValueType, InlineSize>::~SmallVectorSHPP(){
+    this->clear();
+}
+
+template<typename ValueType, int InlineSize>
+SmallVectorSHPP<ValueType, InlineSize>::SmallVectorSHPP(const SmallVectorSHPP<ValueType, InlineSize> & src) : VectorSHPP<ValueType>(reinterpret_cast<ValueType*>(storage), InlineSize){
+    VectorSHPP<ValueType>::operator=(src);
+}
+
+template<typename ValueType, int InlineSize>
+SmallVectorSHPP<ValueType, InlineSize>::SmallVectorSHPP(SmallVectorSHPP<ValueType, InlineSize> && src) : VectorSHPP<ValueType>(reinterpret_cast<ValueType*>(storage), InlineSize){
+    VectorSHPP<ValueType>::operator=(std::move(src));
+}
+
+template<typename ValueType, int InlineSize>
+SmallVectorSHPP<ValueType, InlineSize> & SmallVectorSHPP<ValueType, InlineSize>::operator =(const SmallVectorSHPP<ValueType, InlineSize> & src){
+    VectorSHPP<ValueType>::operator=(src);
+    return *this;
+}
+
+template<typename ValueType, int InlineSize>
+SmallVectorSHPP<ValueType, InlineSize> & SmallVectorSHPP<ValueType, InlineSize>::operator =(SmallVectorSHPP<ValueType, InlineSize> && src){
+    VectorSHPP<ValueType>::operator=(std::move(src));
+    return *this;
+}
+
+#endif // SMALLVECTORSHPP_H
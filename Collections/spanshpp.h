@@ -0,0 +1,160 @@
+/* File: spanshpp.h
+ * -----------------------------------
+ *
+ * This file exports a non owning view of
+ * contiguous elements.
+ */
+
+#ifndef SPANSHPP_H
+#define SPANSHPP_H
+
+#include <iostream>
+#include <stdlib.h>
+#include <type_traits>
+#include "checkshpp.h"
+
+/* Class SpanSHPP<ValueType>
+ * --------------------------------
+ * This class implements a view of a contiguous array of elements
+ * owned by someone else, for example by VectorSHPP. The view is
+ * valid until the owner reallocates or removes its elements.
+ * Use SpanSHPP<const ValueType> for read only access. Iterators
+ * are plain pointers, so the view works with standard algorithms.
+ */
+template<typename ValueType>
+class SpanSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: SpanSHPP
+     * Usage: SpanSHPP<ValueType> span;
+     *        SpanSHPP<ValueType> span(data, size);
+     * -----------------------------------------------------
+     * Initializes a new view of size elements starting from data
+     */
+    SpanSHPP();
+    SpanSHPP(ValueType *data, int size);
+
+    /* Constructor: SpanSHPP
+     * Usage: SpanSHPP<const ValueType> span = mutableSpan;
+     * -----------------------------------------------------
+     * Converts view of mutable elements to read only view
+     */
+    template<typename OtherType,
+             typename = typename std::enable_if<std::is_convertible<OtherType(*)[], ValueType(*)[]>::value>::type>
+    SpanSHPP(const SpanSHPP<OtherType> & src);
+
+    /* Method: data
+     * Usage: ValueType *data = span.data();
+     * -----------------------------------------------------
+     * Returns pointer to the first element of the view
+     */
+    ValueType *data() const;
+
+    /* Method: size
+     * Usage: int size = span.size();
+     * -----------------------------------------------------
+     * Returns the number of elements of this view
+     */
+    int size() const;
+
+    /* Method: isEmpty
+     * Usage: if (span.isEmpty())
+     * -----------------------------------------------------
+     * Returns true if this view has no elements
+     */
+    bool isEmpty() const;
+
+    /* Method: begin, end
+     * Usage: for (ValueType *it = span.begin(); it != span.end(); it++)
+     * -----------------------------------------------------
+     * Return pointers to the first element and past the last one
+     */
+    ValueType *begin() const;
+    ValueType *end() const;
+
+    /* Method: subspan
+     * Usage: SpanSHPP<ValueType> part = span.subspan(from, count);
+     * -----------------------------------------------------
+     * Returns view of count elements starting from the index from
+     */
+    SpanSHPP<ValueType> subspan(int from, int count) const;
+
+    /* Operator: []
+     * Usage: span[index]
+     * -----------------------------------------------------
+     * Overloads [] to select elements from this view.
+     */
+    ValueType & operator[](int) const;
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* First element of the view*/
+    ValueType *array;
+
+    /* Number of the elements in the view*/
+    int count;
+};
+
+/* Implementation of all methods of SpanSHPP class*/
+
+template<typename ValueType>
+SpanSHPP<ValueType>::SpanSHPP(){
+    array = 0;
+    count = 0;
+}
+
+template<typename ValueType>
+SpanSHPP<ValueType>::SpanSHPP(ValueType *data, int size){
+    SHPP_REQUIRE(size >= 0, "Fatal error: size is not valid");
+    array = data;
+    count = size;
+}
+
+template<typename ValueType>
+template<typename OtherType, typename>
+SpanSHPP<ValueType>::SpanSHPP(const SpanSHPP<OtherType> & src){
+    array = src.data();
+    count = src.size();
+}
+
+template<typename ValueType>
+ValueType *SpanSHPP<ValueType>::data() const{
+    return array;
+}
+
+template<typename ValueType>
+int SpanSHPP<ValueType>::size() const{
+    return count;
+}
+
+template<typename ValueType>
+bool SpanSHPP<ValueType>::isEmpty() const{
+    return count == 0;
+}
+
+template<typename ValueType>
+ValueType *SpanSHPP<ValueType>::begin() const{
+    return array;
+}
+
+template<typename ValueType>
+ValueType *SpanSHPP<ValueType>::end() const{
+    return array + count;
+}
+
+template<typename ValueType>
+SpanSHPP<ValueType> SpanSHPP<ValueType>::subspan(int from, int count) const{
+    SHPP_REQUIRE(from >= 0 && count >= 0 && from <= this->count - count, "Fatal error: index is not valid");
+    return SpanSHPP<ValueType>(array + from, count);
+}
+
+template<typename ValueType>
+ValueType & SpanSHPP<ValueType>::operator[](int index) const{
+    SHPP_REQUIRE(index >= 0 && index < count, "Fatal error: index is not valid");
+    return array[index];
+}
+
+#endif // SPANSHPP_H
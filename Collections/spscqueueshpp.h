@@ -0,0 +1,305 @@
+/* File: spscqueueshpp.h
+ * -----------------------------------------------------
+ * This file exports a bounded lock free queue for one
+ * producer thread and one consumer thread.
+ */
+
+#ifndef SPSCQUEUESHPP_H
+#define SPSCQUEUESHPP_H
+
+#include <atomic>
+#include <iostream>
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+/* Class: SPSCQueueSHPP<ValueType>
+ * ---------------------------------------------------
+ * This class implements a queue of a fixed capacity that passes
+ * elements from one producer thread to one consumer thread without
+ * locks. Only the producer may call enqueue methods and only the
+ * consumer may call dequeue methods. Elements live in a circular
+ * array; the producer publishes them by a release store of the
+ * tail and the consumer frees slots by a release store of the head.
+ * Each side keeps a copy of the other side's index and reads the
+ * shared one only when the copy says the queue is full or empty,
+ * so most calls touch no cache line written by the other thread.
+ */
+template <typename ValueType>
+class SPSCQueueSHPP{
+
+    /* Public methods prototypes*/
+public:
+
+    /* Constructor: SPSCQueueSHPP
+     * Usage: SPSCQueueSHPP<ValueType> queue(capacity);
+     * -----------------------------------------------
+     * Initializes a new empty queue for at least capacity
+     * elements, capacity is rounded up to a power of two
+     */
+    explicit SPSCQueueSHPP(int capacity);
+
+    /* Destructor: ~SPSCQueueSHPP
+     * ----------------------------------------------
+     * Destroys the elements left in the queue and frees the array
+     */
+    virtual ~SPSCQueueSHPP();
+
+    /* Method: tryEnqueue
+     * Usage: if (queue.tryEnqueue(value))...
+     * -----------------------------------------------
+     * Adds the value to the end of the queue. Returns false
+     * and leaves the queue unchanged if it is full. Producer only
+     */
+    bool tryEnqueue(ValueType value);
+
+    /* Method: tryDequeue
+     * Usage: if (queue.tryDequeue(value))...
+     * ---------------------------------------------
+     * Moves the first element of the queue to value. Returns
+     * false if the queue is empty. Consumer only
+     */
+    bool tryDequeue(ValueType& value);
+
+    /* Method: tryEnqueueBatch
+     * Usage: int added = queue.tryEnqueueBatch(values, n);
+     * -----------------------------------------------
+     * Adds as many of the n values as fit and publishes them
+     * at once. Returns the number of the added values. Producer only
+     */
+    int tryEnqueueBatch(const ValueType *values, int n);
+
+    /* Method: tryDequeueBatch
+     * Usage: int taken = queue.tryDequeueBatch(values, n);
+     * ---------------------------------------------
+     * Moves up to n first elements to values and frees their
+     * slots at once. Returns the number of the moved elements.
+     * Consumer only
+     */
+    int tryDequeueBatch(ValueType *values, int n);
+
+    /* Method: size
+     * Usage: int size = queue.size();
+     * --------------------------------------------
+     * Returns the number of the elements. The other thread may
+     * change it at any moment, so the result is only a hint
+     */
+    int size() const;
+
+    /* Method: isEmpty
+     * Usage: if (queue.isEmpty())...
+     * --------------------------------------------
+     * Returns true if the queue has no elements, a hint as size
+     */
+    bool isEmpty() const;
+
+    /* Method: capacity
+     * Usage: int capacity = queue.capacity();
+     * --------------------------------------------
+     * Returns the maximal number of the elements
+     */
+    int capacity() const;
+
+    /* Private methods prototypes and instase variables*/
+private:
+
+    /* Size of the cache line*/
+    static const int CACHE_LINE = 64;
+
+    /* Forbid copying, the queue is shared by two threads*/
+    SPSCQueueSHPP(const SPSCQueueSHPP<ValueType>& src);
+    SPSCQueueSHPP<ValueType>& operator=(const SPSCQueueSHPP<ValueType>& src);
+
+    /* Method: freeSlots
+     * Usage: size_t free = freeSlots(tail, n);
+     * ------------------------------------------------
+     * Returns the number of the free slots, reading the head
+     * only if the copy shows less than n of them. Producer only
+     */
+    size_t freeSlots(size_t tail, size_t n);
+
+    /* Method: readySlots
+     * Usage: size_t ready = readySlots(head, n);
+     * ------------------------------------------------
+     * Returns the number of the filled slots, reading the tail
+     * only if the copy shows less than n of them. Consumer only
+     */
+    size_t readySlots(size_t head, size_t n);
+
+    /* Keeps the object data off the lines of its neighbours*/
+    char frontPadding[CACHE_LINE];
+
+    /* Circular array of raw memory and the mask of its index,
+     * written only by the constructor*/
+    ValueType *array;
+    size_t mask;
+
+    char arrayPadding[CACHE_LINE];
+
+    /* Index of the next written element, grows without wrapping,
+     * and the copy of head seen by the producer*/
+    std::atomic<size_t> tail;
+    size_t cachedHead;
+
+    char tailPadding[CACHE_LINE];
+
+    /* Index of the next read element and the copy of tail seen
+     * by the consumer*/
+    std::atomic<size_t> head;
+    size_t cachedTail;
+
+    char headPadding[CACHE_LINE];
+};
+
+
+/* Implementation of all methods of SPSCQueueSHPP class*/
+template <typename ValueType>
+SPSCQueueSHPP<ValueType> :: SPSCQueueSHPP(int capacity){
+    if (capacity < 1){
+        std::cout << "Fatal error: capacity is not valid" << std::endl;
+        exit(1);
+    }
+    size_t size = 1;
+    while (size < (size_t)capacity){
+        size *= 2;
+    }
+    array = static_cast<ValueType*>(::operator new(sizeof(ValueType) * size));
+    mask = size - 1;
+    tail.store(0, std::memory_order_relaxed);
+    head.store(0, std::memory_order_relaxed);
+    cachedHead = 0;
+    cachedTail = 0;
+}
+
+template <typename ValueType>
+SPSCQueueSHPP<ValueType> :: ~SPSCQueueSHPP(){
+    if (!std::is_trivially_destructible<ValueType>::value){
+        size_t last = tail.load(std::memory_order_acquire);
+        for (size_t i = head.load(std::memory_order_relaxed); i != last; i++){
+            array[i & mask].~ValueType();
+        }
+    }
+    ::operator delete(array);
+}
+
+template <typename ValueType>
+size_t SPSCQueueSHPP<ValueType> :: freeSlots(size_t tail, size_t n){
+    size_t free = mask + 1 - (tail - cachedHead);
+    if (free < n){
+        cachedHead = head.load(std::memory_order_acquire);
+        free = mask + 1 - (tail - cachedHead);
+    }
+    return free;
+}
+
+template <typename ValueType>
+size_t SPSCQueueSHPP<ValueType> :: readySlots(size_t head, size_t n){
+    size_t ready = cachedTail - head;
+    if (ready < n){
+        cachedTail = tail.load(std::memory_order_acquire);
+        ready = cachedTail - head;
+    }
+    return ready;
+}
+
+template <typename ValueType>
+bool SPSCQueueSHPP<ValueType> :: tryEnqueue(ValueType value){
+    size_t last = tail.load(std::memory_order_relaxed);
+    if (freeSlots(last, 1) == 0){
+        return false;
+    }
+    new (array + (last & mask)) ValueType(std::move(value));
+    tail.store(last + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename ValueType>
+bool SPSCQueueSHPP<ValueType> :: tryDequeue(ValueType& value){
+    size_t first = head.load(std::memory_order_relaxed);
+    if (readySlots(first, 1) == 0){
+        return false;
+    }
+    ValueType *cell = array + (first & mask);
+    value = std::move(*cell);
+    cell->~ValueType();
+    head.store(first + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename ValueType>
+int SPSCQueueSHPP<ValueType> :: tryEnqueueBatch(const ValueType *values, int n){
+    if (n <= 0){
+        return 0;
+    }
+    size_t last = tail.load(std::memory_order_relaxed);
+    size_t free = freeSlots(last, (size_t)n);
+    size_t count = free < (size_t)n ? free : (size_t)n;
+    size_t start = last & mask;
+    /* Elements up to the end of the array, then from its start*/
+    size_t firstPart = count < mask + 1 - start ? count : mask + 1 - start;
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (firstPart > 0){
+            memcpy(static_cast<void*>(array + start), static_cast<const void*>(values), sizeof(ValueType) * firstPart);
+        }
+        if (count > firstPart){
+            memcpy(static_cast<void*>(array), static_cast<const void*>(values + firstPart), sizeof(ValueType) * (count - firstPart));
+        }
+    } else {
+        for (size_t i = 0; i < count; i++){
+            new (array + ((last + i) & mask)) ValueType(values[i]);
+        }
+    }
+    tail.store(last + count, std::memory_order_release);
+    return (int)count;
+}
+
+template <typename ValueType>
+int SPSCQueueSHPP<ValueType> :: tryDequeueBatch(ValueType *values, int n){
+    if (n <= 0){
+        return 0;
+    }
+    size_t first = head.load(std::memory_order_relaxed);
+    size_t ready = readySlots(first, (size_t)n);
+    size_t count = ready < (size_t)n ? ready : (size_t)n;
+    size_t start = first & mask;
+    size_t firstPart = count < mask + 1 - start ? count : mask + 1 - start;
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (firstPart > 0){
+            memcpy(static_cast<void*>(values), static_cast<const void*>(array + start), sizeof(ValueType) * firstPart);
+        }
+        if (count > firstPart){
+            memcpy(static_cast<void*>(values + firstPart), static_cast<const void*>(array), sizeof(ValueType) * (count - firstPart));
+        }
+    } else {
+        for (size_t i = 0; i < count; i++){
+            ValueType *cell = array + ((first + i) & mask);
+            values[i] = std::move(*cell);
+            cell->~ValueType();
+        }
+    }
+    head.store(first + count, std::memory_order_release);
+    return (int)count;
+}
+
+template <typename ValueType>
+int SPSCQueueSHPP<ValueType> :: size() const{
+    size_t first = head.load(std::memory_order_acquire);
+    size_t last = tail.load(std::memory_order_acquire);
+    /* The head may pass the tail read before it*/
+    return last > first ? (int)(last - first) : 0;
+}
+
+template <typename ValueType>
+bool SPSCQueueSHPP<ValueType> :: isEmpty() const{
+    return size() == 0;
+}
+
+template <typename ValueType>
+int SPSCQueueSHPP<ValueType> :: capacity() const{
+    return (int)(mask + 1);
+}
+
+#endif // SPSCQUEUESHPP_H
@@ -9,6 +9,12 @@
 #define STACKSHPP_H
 
 #include <iostream>
+#include <iterator>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+#include "checkshpp.h"
+#include "serializeshpp.h"
 
 /* Class StackSHPP<ValueType>
  * --------------------------------
@@ -83,6 +89,42 @@ public:
      */
     ValueType peek() const;
 
+    /* Method: pushAll
+     * Usage: stack.pushAll(first, last);
+     * -----------------------------------------------------
+     * Pushes copies of the elements of [first, last) on the stack,
+     * the last element ends on the top. Plain arrays of trivially
+     * copyable elements are copied by memcpy
+     */
+    template<typename Iterator>
+    void pushAll(Iterator first, Iterator last);
+
+    /* Method: popN
+     * Usage: int n = stack.popN(values, max);
+     * -----------------------------------------------------
+     * Removes up to max top elements and moves them to values
+     * in their order on the stack, so the former top element is
+     * the last one and pushAll(values, values + n) restores the
+     * stack. Returns the number of the removed elements
+     */
+    int popN(ValueType *values, int max);
+
+    /* Method: save
+     * Usage: stack.save(out);
+     * -----------------------------------------------------
+     * Writes all elements from the bottom to the top to the
+     * binary stream
+     */
+    void save(std::ostream& out) const;
+
+    /* Method: load
+     * Usage: stack.load(in);
+     * -----------------------------------------------------
+     * Replaces the content of the stack by the elements read
+     * from the binary stream written by save
+     */
+    void load(std::istream& in);
+
     /* Private methods prototypes and instase variables*/
 private:
     static const int START_SIZE = 10;
@@ -97,11 +139,24 @@ private:
     int count;
 
     /* Method: extendArray
-     * Usage: extendArray();
+     * Usage: extendArray(minSize);
      * ------------------------------------------------
-     * Increases dynamyc arra in two times
+     * Doubles dynamyc array until it holds minSize elements
+     * and moves the elements to the new array once
      */
-    void extendArray();
+    void extendArray(int minSize);
+
+    /* Method: copyRange
+     * Usage: copyRange(first, n, to);
+     * ------------------------------------------------
+     * Assigns n elements starting from first to the elements
+     * of to. Plain arrays of trivially copyable elements are
+     * copied by memcpy
+     */
+    template<typename Iterator>
+    static void copyRange(Iterator first, int n, ValueType *to);
+    static void copyRange(const ValueType *first, int n, ValueType *to);
+    static void copyRange(ValueType *first, int n, ValueType *to);
 };
 
 
@@ -122,7 +177,7 @@ StackSHPP<ValueType>::~StackSHPP(){
 template <typename ValueType>
 void StackSHPP<ValueType>::push(ValueType value){
     if (count == currentSize){ //check for a free space for new element
-        extendArray();
+        extendArray(count + 1);
     }
     array[count] = value;
     count++;
@@ -130,10 +185,7 @@ void StackSHPP<ValueType>::push(ValueType value){
 
 template <typename ValueType>
 ValueType StackSHPP<ValueType>::pop(){
-    if (isEmpty()){
-        std:: cout << "Error: Stack is empty!!!" << std::endl;
-        exit(1);
-    }
+    SHPP_REQUIRE(!isEmpty(), "Error: Stack is empty!!!");
     count--;
     return array[count];
 
@@ -152,10 +204,7 @@ bool StackSHPP<ValueType>::isEmpty() const {
 
 template <typename ValueType>
 ValueType StackSHPP<ValueType>::top() const {
-    if (isEmpty()){
-        std:: cout << "Error: Stack is empty!!!" << std::endl;
-        exit(1);
-    }
+    SHPP_REQUIRE(!isEmpty(), "Error: Stack is empty!!!");
     return array[count-1];
 }
 
@@ -166,19 +215,101 @@ int StackSHPP<ValueType>::size() const{
 }
 
 template <typename ValueType>
-void StackSHPP<ValueType>::extendArray(){
+void StackSHPP<ValueType>::extendArray(int minSize){
     ValueType *oldArray = array;
-    currentSize *= 2;
+    while (currentSize < minSize){
+        currentSize *= 2;
+    }
     array = new ValueType[currentSize];
 
-    for (int i = 0; i < count; i++){
-        array[i] = oldArray[i];
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (count > 0){
+            memcpy(static_cast<void*>(array), static_cast<const void*>(oldArray), sizeof(ValueType) * count);
+        }
+    } else {
+        for (int i = 0; i < count; i++){
+            array[i] = std::move(oldArray[i]);
+        }
     }
     delete[] oldArray;
 }
 
+template <typename ValueType>
+template<typename Iterator>
+void StackSHPP<ValueType>::pushAll(Iterator first, Iterator last){
+    int n = (int)std::distance(first, last);
+    if (count + n > currentSize){
+        extendArray(count + n);
+    }
+    copyRange(first, n, array + count);
+    count += n;
+}
+
+template <typename ValueType>
+int StackSHPP<ValueType>::popN(ValueType *values, int max){
+    int n = max < count ? max : count;
+    if (n <= 0){
+        return 0;
+    }
+    count -= n;
+    if (std::is_trivially_copyable<ValueType>::value){
+        memcpy(static_cast<void*>(values), static_cast<const void*>(array + count), sizeof(ValueType) * n);
+    } else {
+        for (int i = 0; i < n; i++){
+            values[i] = std::move(array[count + i]);
+        }
+    }
+    return n;
+}
+
+template <typename ValueType>
+template<typename Iterator>
+void StackSHPP<ValueType>::copyRange(Iterator first, int n, ValueType *to){
+    for (int i = 0; i < n; i++, ++first){
+        to[i] = *first;
+    }
+}
+
+template <typename ValueType>
+void StackSHPP<ValueType>::copyRange(const ValueType *first, int n, ValueType *to){
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (n > 0){
+            memcpy(static_cast<void*>(to), static_cast<const void*>(first), sizeof(ValueType) * n);
+        }
+    } else {
+        for (int i = 0; i < n; i++){
+            to[i] = first[i];
+        }
+    }
+}
+
+template <typename ValueType>
+void StackSHPP<ValueType>::copyRange(ValueType *first, int n, ValueType *to){
+    copyRange(static_cast<const ValueType*>(first), n, to);
+}
+
+template <typename ValueType>
+void StackSHPP<ValueType>::save(std::ostream& out) const{
+    SerializeSHPP::writeHeader(out, SerializeSHPP::STACK, 0, sizeof(ValueType), count);
+    SerializerSHPP<ValueType>::writeArray(out, array, count);
+}
+
+template <typename ValueType>
+void StackSHPP<ValueType>::load(std::istream& in){
+    int n = SerializeSHPP::readHeader(in, SerializeSHPP::STACK, 0, sizeof(ValueType));
+    if (n > currentSize){
+        delete[] array;
+        currentSize = n;
+        array = new ValueType[currentSize];
+    }
+    SerializerSHPP<ValueType>::readArray(in, array, n);
+    SerializeSHPP::checkStream(in);
+    count = n;
+}
+
 template <typename ValueType>
 ValueType StackSHPP<ValueType>::peek() const{
+    SHPP_REQUIRE(!isEmpty(), "Error: Stack is empty!!!");
     return array[count-1];
 }
 
@@ -10,10 +10,33 @@
 #define VECTORSHPP_H
 
 #include <iostream>
+#include <iterator>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "checkshpp.h"
+#include "spanshpp.h"
+#include "serializeshpp.h"
+
+/* Growth factor of the array is VECTORSHPP_GROWTH_NUMERATOR /
+ * VECTORSHPP_GROWTH_DENOMINATOR. Define them before including
+ * this file to choose another factor, for example 3 / 2.
+ */
+#ifndef VECTORSHPP_GROWTH_NUMERATOR
+#define VECTORSHPP_GROWTH_NUMERATOR 2
+#endif
+
+#ifndef VECTORSHPP_GROWTH_DENOMINATOR
+#define VECTORSHPP_GROWTH_DENOMINATOR 1
+#endif
 
 /* Class VectorSHPP<ValueType>
  * --------------------------------
  * This class implements a vector of a specified value type.
+ * Spare capacity is kept as raw memory, elements are constructed
+ * only when they are added.
  */
 template<typename ValueType>
 class VectorSHPP{
@@ -24,7 +47,8 @@ public:
     /* Constructor: VectorSHPP
      * Usage: VectorSHPP<ValueType> vector;
      * -----------------------------------------------------
-     * Initializes a new empty vector
+     * Initializes a new empty vector. Memory is not allocated
+     * until the first element is added
      */
     VectorSHPP();
 
@@ -39,7 +63,17 @@ public:
      * -----------------------------------------------------
      * Add the specified value in the vector
      */
-    void add(ValueType);
+    void add(const ValueType& value);
+    void add(ValueType&& value);
+
+    /* Method: emplaceBack
+     * Usage: vector.emplaceBack(args...);
+     * -----------------------------------------------------
+     * Constructs new element from the received arguments right
+     * at the end of the vector
+     */
+    template<typename... Args>
+    void emplaceBack(Args&&... args);
 
     /* Method: clear
      * Usage: vector.clear();
@@ -58,10 +92,22 @@ public:
     /* Method: insert
      * Usage: vector.insert(index, value);
      * -----------------------------------------------------
-     * Inserts element in this vector in the specified index
+     * Inserts element in this vector in the specified index.
+     * Index equal to size() appends the element
      */
     void insert(int, ValueType);
 
+    /* Method: insertRange
+     * Usage: vector.insertRange(index, first, last);
+     * -----------------------------------------------------
+     * Inserts copies of the elements of [first, last) starting
+     * from the specified index, shifting the tail only once.
+     * Plain arrays of trivially copyable elements are copied
+     * by memcpy. The range must not point into this vector
+     */
+    template<typename Iterator>
+    void insertRange(int index, Iterator first, Iterator last);
+
     /* Method: isEmpty
      * Usage: if (vector.isEmpty())
      * -----------------------------------------------------
@@ -76,12 +122,30 @@ public:
      */
     void remove(int);
 
+    /* Method: removeRange
+     * Usage: vector.removeRange(from, to);
+     * -----------------------------------------------------
+     * Removes elements with indexes in [from, to), shifting the
+     * tail only once
+     */
+    void removeRange(int from, int to);
+
+    /* Method: eraseIf
+     * Usage: int removed = vector.eraseIf([](const ValueType& value) { return ...; });
+     * -----------------------------------------------------
+     * Removes all elements for which predicate returns true in
+     * one pass, keeps the order of the others. Returns the
+     * number of removed elements
+     */
+    template<typename Predicate>
+    int eraseIf(Predicate predicate);
+
     /* Method: set
      * Usage: vector.set(index, value);
      * -----------------------------------------------------
      * Replaces the value at the specified index
      */
-    void set(int, ValueType);
+    void set(int, const ValueType&);
 
     /* Method: size
      * Usage: int = vector.size();
@@ -90,16 +154,96 @@ public:
      */
     int size() const;
 
+    /* Method: capacity
+     * Usage: int capacity = vector.capacity();
+     * -----------------------------------------------------
+     * Returns the number of elements this vector can hold
+     * without reallocation
+     */
+    int capacity() const;
+
+    /* Method: reserve
+     * Usage: vector.reserve(n);
+     * -----------------------------------------------------
+     * Makes capacity at least n, so adding up to n elements
+     * does not reallocate the array
+     */
+    void reserve(int n);
+
+    /* Method: resize
+     * Usage: vector.resize(n);
+     * -----------------------------------------------------
+     * Changes the number of elements to n. Removes elements from
+     * the end or adds default constructed ones
+     */
+    void resize(int n);
+
+    /* Method: shrinkToFit
+     * Usage: vector.shrinkToFit();
+     * -----------------------------------------------------
+     * Reduces capacity to the current number of elements and
+     * frees the rest of the memory
+     */
+    void shrinkToFit();
+
     /* Operator: []
      * Usage: vec[index]
      * -----------------------------------------------------
      * Overloads [] to select elements from this vector.
      */
     const ValueType & operator[](int)const;
+    ValueType & operator[](int);
+
+    /* Method: data
+     * Usage: ValueType *data = vector.data();
+     * -----------------------------------------------------
+     * Returns pointer to the contiguous elements of this vector.
+     * It stays valid until the vector reallocates its array
+     */
+    ValueType *data();
+    const ValueType *data() const;
+
+    /* Method: begin, end
+     * Usage: std::sort(vector.begin(), vector.end());
+     * -----------------------------------------------------
+     * Return random access iterators to the first element and
+     * past the last one. Iterators are plain pointers
+     */
+    ValueType *begin();
+    const ValueType *begin() const;
+    ValueType *end();
+    const ValueType *end() const;
+
+    /* Method: view
+     * Usage: SpanSHPP<ValueType> span = vector.view();
+     * -----------------------------------------------------
+     * Returns view of all elements of this vector
+     */
+    SpanSHPP<ValueType> view();
+    SpanSHPP<const ValueType> view() const;
+
+    /* Method: save
+     * Usage: vector.save(out);
+     * -----------------------------------------------------
+     * Writes all elements to the binary stream. Elements of
+     * trivially copyable type are written by one call
+     */
+    void save(std::ostream& out) const;
+
+    /* Method: load
+     * Usage: vector.load(in);
+     * -----------------------------------------------------
+     * Replaces the content of the vector by the elements read
+     * from the binary stream written by save
+     */
+    void load(std::istream& in);
 
     /* Copy constructor*/
     VectorSHPP(const VectorSHPP<ValueType> & src);
 
+    /* Move constructor, takes the array of src and leaves it empty*/
+    VectorSHPP(VectorSHPP<ValueType> && src);
+
     /* Operator: =
      * vectorNew = vectorOld;
      * -----------------------------------------------------
@@ -107,12 +251,38 @@ public:
      */
     VectorSHPP<ValueType> & operator=(const VectorSHPP<ValueType> & src);
 
+    /* Operator: =
+     * vectorNew = std::move(vectorOld);
+     * -----------------------------------------------------
+     * Takes the array of src and leaves it empty
+     */
+    VectorSHPP<ValueType> & operator=(VectorSHPP<ValueType> && src);
+
+    /* Protected methods prototypes*/
+protected:
+
+    /* Constructor: VectorSHPP
+     * Usage: VectorSHPP<ValueType>(buffer, size);
+     * -----------------------------------------------------
+     * Initializes a new empty vector that keeps up to size
+     * elements in the received raw buffer and moves to the heap
+     * only when it outgrows it. The buffer is owned by the
+     * derived class and is never freed by the vector
+     */
+    VectorSHPP(ValueType *inlineArray, int inlineSize);
+
     /* Private methods prototypes and instase variables*/
 private:
 
     /* Dynamic array for storing elements*/
     ValueType *array;
 
+    /* Raw buffer of the derived class, 0 if there is none*/
+    ValueType *inlineArray;
+
+    /* Number of elements that fit into the inline buffer*/
+    int inlineSize;
+
     /* Current size of the dynamic array*/
     int currentSize;
 
@@ -125,10 +295,91 @@ private:
     /* Method: extendArray
      * Usage: extendArray();
      * ------------------------------------------------
-     * Increases dynamyc array in two times
+     * Increases dynamyc array by the growth factor
      */
     void extendArray();
 
+    /* Method: grownSize
+     * Usage: int newSize = grownSize();
+     * ------------------------------------------------
+     * Returns the size of the array after the next growth
+     */
+    int grownSize() const;
+
+    /* Method: reallocate
+     * Usage: reallocate(newSize);
+     * ------------------------------------------------
+     * Moves elements to a new array of received size
+     */
+    void reallocate(int newSize);
+
+    /* Method: allocateArray
+     * Usage: ValueType *array = allocateArray(size);
+     * ------------------------------------------------
+     * Allocates raw memory for size elements without
+     * constructing them
+     */
+    static ValueType *allocateArray(int size);
+
+    /* Method: relocate
+     * Usage: relocate(from, n, to);
+     * ------------------------------------------------
+     * Moves n elements to the raw memory and destroys the
+     * originals. Trivially copyable elements are copied by memcpy
+     */
+    static void relocate(ValueType *from, int n, ValueType *to);
+
+    /* Method: constructRange
+     * Usage: constructRange(first, n, to);
+     * ------------------------------------------------
+     * Copies n elements starting from first to the raw memory.
+     * Plain arrays of trivially copyable elements are copied
+     * by memcpy
+     */
+    template<typename Iterator>
+    static void constructRange(Iterator first, int n, ValueType *to);
+    static void constructRange(const ValueType *first, int n, ValueType *to);
+    static void constructRange(ValueType *first, int n, ValueType *to);
+
+    /* Method: releaseArray
+     * Usage: releaseArray(array);
+     * ------------------------------------------------
+     * Frees the received memory unless it is the inline buffer
+     */
+    void releaseArray(ValueType *memory);
+
+    /* Method: takeStorage
+     * Usage: takeStorage(src);
+     * ------------------------------------------------
+     * Moves elements of src to this empty vector. Heap array
+     * of src is taken as is, elements of the inline buffer are
+     * relocated. Leaves src empty
+     */
+    void takeStorage(VectorSHPP<ValueType> & src);
+
+    /* Method: openGap
+     * Usage: openGap(index, n);
+     * ------------------------------------------------
+     * Moves elements from the index n positions to the end,
+     * growing the array if needed. Leaves raw memory in the gap
+     */
+    void openGap(int index, int n);
+
+    /* Method: closeGap
+     * Usage: closeGap(index, n);
+     * ------------------------------------------------
+     * Moves elements after the raw gap [index, index + n)
+     * n positions to the beginning
+     */
+    void closeGap(int index, int n);
+
+    /* Method: destroyElements
+     * Usage: destroyElements();
+     * ------------------------------------------------
+     * Destroys all elements, the memory stays allocated
+     */
+    void destroyElements();
+
     /* Method: deepCoping;
      * Usage: deepCoping(VectorSHPP src);
      * ------------------------------------------------
@@ -142,66 +393,154 @@ private:
 
 template<typename ValueType>
 VectorSHPP<ValueType>::VectorSHPP(){
-    array = new ValueType[START_SIZE];
-    currentSize = START_SIZE;
+    array = 0;
+    currentSize = 0;
+    count = 0;
+    inlineArray = 0;
+    inlineSize = 0;
+}
+
+template<typename ValueType>
+VectorSHPP<ValueType>::VectorSHPP(ValueType *inlineArray, int inlineSize){
+    array = inlineArray;
+    currentSize = inlineSize;
     count = 0;
+    this->inlineArray = inlineArray;
+    this->inlineSize = inlineSize;
 }
 
 template<typename ValueType>
 const ValueType & VectorSHPP<ValueType>::operator[](int index)const{
-    if(index < 0 || index >= count){
-        std::cout << "Fatal error: index is not valid" << std::endl;
-        exit(1);
-    }
+    SHPP_REQUIRE(index >= 0 && index < count, "Fatal error: index is not valid");
+
+    return array[index];
+}
+
+template<typename ValueType>
+ValueType & VectorSHPP<ValueType>::operator[](int index){
+    SHPP_REQUIRE(index >= 0 && index < count, "Fatal error: index is not valid");
 
     return array[index];
 }
 
 template<typename ValueType>
-void VectorSHPP<ValueType>::add(ValueType value){
-    if (count == currentSize) extendArray();
+ValueType *VectorSHPP<ValueType>::data(){
+    return array;
+}
+
+template<typename ValueType>
+const ValueType *VectorSHPP<ValueType>::data() const{
+    return array;
+}
+
+template<typename ValueType>
+ValueType *VectorSHPP<ValueType>::begin(){
+    return array;
+}
+
+template<typename ValueType>
+const ValueType *VectorSHPP<ValueType>::begin() const{
+    return array;
+}
+
+template<typename ValueType>
+ValueType *VectorSHPP<ValueType>::end(){
+    return array + count;
+}
+
+template<typename ValueType>
+const ValueType *VectorSHPP<ValueType>::end() const{
+    return array + count;
+}
 
-    array[count] = value;
+template<typename ValueType>
+SpanSHPP<ValueType> VectorSHPP<ValueType>::view(){
+    return SpanSHPP<ValueType>(array, count);
+}
+
+template<typename ValueType>
+SpanSHPP<const ValueType> VectorSHPP<ValueType>::view() const{
+    return SpanSHPP<const ValueType>(array, count);
+}
+
+template<typename ValueType>
+void VectorSHPP<ValueType>::save(std::ostream& out) const{
+    SerializeSHPP::writeHeader(out, SerializeSHPP::VECTOR, 0, sizeof(ValueType), count);
+    SerializerSHPP<ValueType>::writeArray(out, array, count);
+}
+
+template<typename ValueType>
+void VectorSHPP<ValueType>::load(std::istream& in){
+    int n = SerializeSHPP::readHeader(in, SerializeSHPP::VECTOR, 0, sizeof(ValueType));
+    destroyElements();
+    reserve(n);
+    if (std::is_trivially_copyable<ValueType>::value){
+        SerializerSHPP<ValueType>::readArray(in, array, n);
+        count = n;
+    } else {
+        resize(n);
+        SerializerSHPP<ValueType>::readArray(in, array, n);
+    }
+    SerializeSHPP::checkStream(in);
+}
+
+template<typename ValueType>
+void VectorSHPP<ValueType>::add(const ValueType& value){
+    emplaceBack(value);
+}
+
+template<typename ValueType>
+void VectorSHPP<ValueType>::add(ValueType&& value){
+    emplaceBack(std::move(value));
+}
+
+template<typename ValueType>
+template<typename... Args>
+void VectorSHPP<ValueType>::emplaceBack(Args&&... args){
+    if (count == currentSize){
+        /* The new element is built before relocation, so args may
+         * refer to elements of this vector*/
+        int newSize = grownSize();
+        ValueType *newArray = allocateArray(newSize);
+        new (newArray + count) ValueType(std::forward<Args>(args)...);
+        relocate(array, count, newArray);
+        releaseArray(array);
+        array = newArray;
+        currentSize = newSize;
+    } else {
+        new (array + count) ValueType(std::forward<Args>(args)...);
+    }
     count++;
 }
 
 template <typename ValueType>
 void VectorSHPP<ValueType>::clear(){
-    count = 0;
+    destroyElements();
 }
 
 template <typename ValueType>
 ValueType VectorSHPP<ValueType>::get(int index) const{
-    if(index < 0 || index >= count){
-        std::cout << "Fatal error: index is not valid" << std::endl;
-        exit(1);
-    }
+    SHPP_REQUIRE(index >= 0 && index < count, "Fatal error: index is not valid");
 
     return array[index];
 }
 
 template <typename ValueType>
 void VectorSHPP<ValueType>::insert(int index, ValueType value){
-    if (count == currentSize) extendArray();
-    if(index < 0 || index >= count){
-        std::cout << "Fatal error: index is not valid" << std::endl;
-        exit(1);
-    }
-
-    ValueType *tmpArray = new ValueType[count - index];
-    int j = 0;
-    for(int i = index; i < count; i++){
-        tmpArray[j] = array[i];
-        j++;
-    }
-    j = 0;
-    array[index] = value;
-    for (int i = index + 1; i <= count; i++){
-        array[i] = tmpArray[j];
-        j++;
-    }
+    SHPP_REQUIRE(index >= 0 && index <= count, "Fatal error: index is not valid");
+    openGap(index, 1);
+    new (array + index) ValueType(std::move(value));
     count++;
+}
 
+template <typename ValueType>
+template <typename Iterator>
+void VectorSHPP<ValueType>::insertRange(int index, Iterator first, Iterator last){
+    SHPP_REQUIRE(index >= 0 && index <= count, "Fatal error: index is not valid");
+    int n = (int)std::distance(first, last);
+    openGap(index, n);
+    constructRange(first, n, array + index);
+    count += n;
 }
 
 template <typename ValueType>
@@ -211,23 +550,83 @@ bool VectorSHPP<ValueType>::isEmpty() const{
 
 template <typename ValueType>
 void VectorSHPP<ValueType>::remove(int index){
-    if(index < 0 || index >= count){
-        std::cout << "Fatal error: index is not valid" << std::endl;
-        exit(1);
+    SHPP_REQUIRE(index >= 0 && index < count, "Fatal error: index is not valid");
+    removeRange(index, index + 1);
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::removeRange(int from, int to){
+    SHPP_REQUIRE(from >= 0 && from <= to && to <= count, "Fatal error: index is not valid");
+    if (!std::is_trivially_destructible<ValueType>::value){
+        for (int i = from; i < to; i++){
+            array[i].~ValueType();
+        }
     }
-    for(int i = index; i < count-1; i++){
-        array[i] = array[i+1];
+    closeGap(from, to - from);
+    count -= to - from;
+}
+
+template <typename ValueType>
+template <typename Predicate>
+int VectorSHPP<ValueType>::eraseIf(Predicate predicate){
+    int write = 0;
+    for (int read = 0; read < count; read++){
+        if (predicate(array[read])){
+            array[read].~ValueType();
+        } else {
+            if (write != read){
+                new (array + write) ValueType(std::move(array[read]));
+                array[read].~ValueType();
+            }
+            write++;
+        }
     }
-    count--;
+    int removed = count - write;
+    count = write;
+    return removed;
 }
 
+template <typename ValueType>
+void VectorSHPP<ValueType>::openGap(int index, int n){
+    if (n == 0){
+        return;
+    }
+    if (count + n > currentSize){
+        int newSize = grownSize();
+        reallocate(newSize < count + n ? count + n : newSize);
+    }
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (count > index){
+            memmove(static_cast<void*>(array + index + n), static_cast<const void*>(array + index), sizeof(ValueType) * (count - index));
+        }
+    } else {
+        for (int i = count - 1; i >= index; i--){
+            new (array + i + n) ValueType(std::move(array[i]));
+            array[i].~ValueType();
+        }
+    }
+}
 
 template <typename ValueType>
-void VectorSHPP<ValueType>::set(int index, ValueType value){
-    if(index < 0 || index >= count){
-        std::cout << "Fatal error: index is not valid" << std::endl;
-        exit(1);
+void VectorSHPP<ValueType>::closeGap(int index, int n){
+    if (n == 0){
+        return;
     }
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (count > index + n){
+            memmove(static_cast<void*>(array + index), static_cast<const void*>(array + index + n), sizeof(ValueType) * (count - index - n));
+        }
+    } else {
+        for (int i = index + n; i < count; i++){
+            new (array + i - n) ValueType(std::move(array[i]));
+            array[i].~ValueType();
+        }
+    }
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::set(int index, const ValueType& value){
+    SHPP_REQUIRE(index >= 0 && index < count, "Fatal error: index is not valid");
     array[index] = value;
 }
 
@@ -236,43 +635,224 @@ int VectorSHPP<ValueType>::size() const{
     return count;
 }
 
+template <typename ValueType>
+ValueType *VectorSHPP<ValueType>::allocateArray(int size){
+    return static_cast<ValueType*>(::operator new(sizeof(ValueType) * size));
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::relocate(ValueType *from, int n, ValueType *to){
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (n > 0){
+            memcpy(static_cast<void*>(to), static_cast<const void*>(from), sizeof(ValueType) * n);
+        }
+    } else {
+        for (int i = 0; i < n; i++){
+            new (to + i) ValueType(std::move(from[i]));
+            from[i].~ValueType();
+        }
+    }
+}
+
+template <typename ValueType>
+template<typename Iterator>
+void VectorSHPP<ValueType>::constructRange(Iterator first, int n, ValueType *to){
+    for (int i = 0; i < n; i++, ++first){
+        new (to + i) ValueType(*first);
+    }
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::constructRange(const ValueType *first, int n, ValueType *to){
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (n > 0){
+            memcpy(static_cast<void*>(to), static_cast<const void*>(first), sizeof(ValueType) * n);
+        }
+    } else {
+        for (int i = 0; i < n; i++){
+            new (to + i) ValueType(first[i]);
+        }
+    }
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::constructRange(ValueType *first, int n, ValueType *to){
+    constructRange(static_cast<const ValueType*>(first), n, to);
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::releaseArray(ValueType *memory){
+    if (memory != inlineArray){
+        ::operator delete(memory);
+    }
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::takeStorage(VectorSHPP<ValueType> &src){
+    if (src.array != src.inlineArray){
+        array = src.array;
+        currentSize = src.currentSize;
+        count = src.count;
+        src.array = src.inlineArray;
+        src.currentSize = src.inlineSize;
+    } else {
+        reserve(src.count);
+        relocate(src.array, src.count, array);
+        count = src.count;
+    }
+    src.count = 0;
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::destroyElements(){
+    if (!std::is_trivially_destructible<ValueType>::value){
+        for (int i = 0; i < count; i++){
+            array[i].~ValueType();
+        }
+    }
+    count = 0;
+}
+
+template <typename ValueType>
+int VectorSHPP<ValueType>::capacity() const{
+    return currentSize;
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::reserve(int n){
+    if (n > currentSize){
+        reallocate(n);
+    }
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::resize(int n){
+    if (n < 0){
+        std::cout << "Fatal error: size is not valid" << std::endl;
+        exit(1);
+    }
+    if (n < count){
+        if (!std::is_trivially_destructible<ValueType>::value){
+            for (int i = n; i < count; i++){
+                array[i].~ValueType();
+            }
+        }
+    } else {
+        reserve(n);
+        for (int i = count; i < n; i++){
+            new (array + i) ValueType();
+        }
+    }
+    count = n;
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::shrinkToFit(){
+    if (count == currentSize || array == inlineArray){
+        return;
+    }
+    if (count <= inlineSize){
+        /* Elements fit into the inline buffer again*/
+        relocate(array, count, inlineArray);
+        releaseArray(array);
+        array = inlineArray;
+        currentSize = inlineSize;
+    } else {
+        reallocate(count);
+    }
+}
+
 template <typename ValueType>
 void VectorSHPP<ValueType>::extendArray(){
-    ValueType *oldArray = array;
-    currentSize *= 2;
-    array = new ValueType[currentSize];
+    reallocate(grownSize());
+}
 
-    for (int i = 0; i < count; i++){
-        array[i] = oldArray[i];
+template <typename ValueType>
+int VectorSHPP<ValueType>::grownSize() const{
+    static_assert(VECTORSHPP_GROWTH_NUMERATOR > VECTORSHPP_GROWTH_DENOMINATOR && VECTORSHPP_GROWTH_DENOMINATOR > 0,
+                  "VectorSHPP growth factor must be greater than 1");
+    long long newSize = (long long)currentSize * VECTORSHPP_GROWTH_NUMERATOR / VECTORSHPP_GROWTH_DENOMINATOR;
+    if (newSize <= currentSize){
+        newSize = currentSize + 1;
+    }
+    if (newSize < START_SIZE){
+        newSize = START_SIZE;
     }
-    delete[] oldArray;
+    return (int)newSize;
+}
+
+template <typename ValueType>
+void VectorSHPP<ValueType>::reallocate(int newSize){
+    ValueType *oldArray = array;
+    array = allocateArray(newSize);
+    relocate(oldArray, count, array);
+    releaseArray(oldArray);
+    currentSize = newSize;
 }
 
 template<typename ValueType>
 void VectorSHPP<ValueType>::deepCoping(const VectorSHPP<ValueType> &src){
-    this->array = new ValueType[src.currentSize];
+    if (inlineArray != 0 && src.count <= inlineSize){
+        array = inlineArray;
+        currentSize = inlineSize;
+    } else {
+        array = allocateArray(src.currentSize);
+        currentSize = src.currentSize;
+    }
     count = src.count;
-    currentSize = src.currentSize;
-    for (int i = 0; i < src.count; i++){
-        array[i] = src.array[i];
+    if (std::is_trivially_copyable<ValueType>::value){
+        if (count > 0){
+            memcpy(static_cast<void*>(array), static_cast<const void*>(src.array), sizeof(ValueType) * count);
+        }
+    } else {
+        for (int i = 0; i < src.count; i++){
+            new (array + i) ValueType(src.array[i]);
+        }
     }
 }
 
 template<typename ValueType>
 VectorSHPP<ValueType>::VectorSHPP(const VectorSHPP<ValueType> & src){
+    inlineArray = 0;
+    inlineSize = 0;
     deepCoping(src);
 }
 
+template<typename ValueType>
+VectorSHPP<ValueType>::VectorSHPP(VectorSHPP<ValueType> && src){
+    array = 0;
+    currentSize = 0;
+    count = 0;
+    inlineArray = 0;
+    inlineSize = 0;
+    takeStorage(src);
+}
+
 template<typename ValueType>
 VectorSHPP<ValueType> & VectorSHPP<ValueType>::operator =(const VectorSHPP<ValueType> & src){
-    delete[] array;
-    deepCoping(src);
+    if (this != &src){
+        destroyElements();
+        releaseArray(array);
+        deepCoping(src);
+    }
+    return *this;
+}
+
+template<typename ValueType>
+VectorSHPP<ValueType> & VectorSHPP<ValueType>::operator =(VectorSHPP<ValueType> && src){
+    if (this != &src){
+        destroyElements();
+        releaseArray(array);
+        array = inlineArray;
+        currentSize = inlineSize;
+        takeStorage(src);
+    }
     return *this;
 }
 
 template<typename ValueType>
 VectorSHPP<ValueType>::~VectorSHPP(){
-    count = 0;
-    delete [] array;
+    destroyElements();
+    releaseArray(array);
 }
 #endif // VECTORSHPP
@@ -0,0 +1,66 @@
+/* File: btree_vs_avl.cpp
+ * -----------------------------------------------------
+ * Compares BTreeMapSHPP with the AVL tree MapSHPP on random
+ * int keys: put, get of every key and a full in-order walk.
+ * Build and run from this directory:
+ *     g++ -std=c++14 -O2 -I../Collections btree_vs_avl.cpp -o btree_vs_avl && ./btree_vs_avl [count]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include "btreemapshpp.h"
+#include "mapshpp.h"
+#include "vectorshpp.h"
+
+/* Keys from a fixed xorshift sequence, the same for both maps*/
+static VectorSHPP<int> randomKeys(int n){
+    VectorSHPP<int> keys;
+    uint32_t state = 2463534242u;
+    for (int i = 0; i < n; i++){
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        keys.add((int)(state & 0x7fffffff));
+    }
+    return keys;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Map>
+static void run(const char* name, const VectorSHPP<int>& keys){
+    Map map;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < keys.size(); i++){
+        map.put(keys[i], i);
+    }
+    double putTime = secondsSince(start);
+
+    long long sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < keys.size(); i++){
+        sum += map.get(keys[i]);
+    }
+    double getTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (typename Map::iterator it = map.begin(); it != map.end(); ++it){
+        sum += it.value();
+    }
+    double walkTime = secondsSince(start);
+
+    std::cout << name << ": put " << putTime << " s, get " << getTime
+              << " s, walk " << walkTime << " s (" << map.size() << " keys, check " << sum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]){
+    int n = argc > 1 ? atoi(argv[1]) : 4000000;
+    VectorSHPP<int> keys = randomKeys(n);
+    run<MapSHPP<int, int> >("MapSHPP (AVL)   ", keys);
+    run<BTreeMapSHPP<int, int> >("BTreeMapSHPP (B+)", keys);
+    return 0;
+}
@@ -0,0 +1,117 @@
+/* File: mpmc_vs_mutex.cpp
+ * -----------------------------------------------------
+ * Compares MPMCQueueSHPP with QueueSHPP guarded by a mutex and
+ * a condition variable. Each run starts the same number of
+ * producer and consumer threads; every producer enqueues count
+ * ints and every consumer dequeues count ints. Scaling only shows
+ * on a multi core machine.
+ * Build and run from this directory:
+ *     g++ -std=c++14 -O2 -pthread -I../Collections mpmc_vs_mutex.cpp -o mpmc_vs_mutex && ./mpmc_vs_mutex [count]
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <stdlib.h>
+#include <thread>
+#include "mpmcqueueshpp.h"
+#include "queueshpp.h"
+#include "vectorshpp.h"
+
+/* Capacity of the bounded queue*/
+static const int CAPACITY = 1024;
+
+/* QueueSHPP shared under one mutex, consumers sleep while it is empty*/
+class LockedQueue {
+public:
+    void enqueue(int value){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.enqueue(value);
+        }
+        notEmpty.notify_one();
+    }
+
+    void dequeue(int& value){
+        std::unique_lock<std::mutex> lock(mutex);
+        while (queue.isEmpty()){
+            notEmpty.wait(lock);
+        }
+        value = queue.dequeue();
+    }
+
+private:
+    QueueSHPP<int> queue;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+};
+
+/* Adapter giving MPMCQueueSHPP the same interface*/
+class LockFreeQueue {
+public:
+    LockFreeQueue() : queue(CAPACITY) {}
+
+    void enqueue(int value){
+        queue.enqueue(value);
+    }
+
+    void dequeue(int& value){
+        queue.dequeue(value);
+    }
+
+private:
+    MPMCQueueSHPP<int> queue;
+};
+
+/* Returns seconds spent to pass pairs * count elements through the queue*/
+template<typename Queue>
+static double run(int pairs, int count, long long& sum){
+    Queue queue;
+    VectorSHPP<long long> sums;
+    for (int i = 0; i < pairs; i++){
+        sums.add(0);
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    VectorSHPP<std::thread*> threads;
+    for (int i = 0; i < pairs; i++){
+        threads.add(new std::thread([&queue, count](){
+            for (int j = 0; j < count; j++){
+                queue.enqueue(j);
+            }
+        }));
+        threads.add(new std::thread([&queue, &sums, count, i](){
+            long long local = 0;
+            int value;
+            for (int j = 0; j < count; j++){
+                queue.dequeue(value);
+                local += value;
+            }
+            sums[i] = local;
+        }));
+    }
+    for (int i = 0; i < threads.size(); i++){
+        threads[i]->join();
+        delete threads[i];
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sum = 0;
+    for (int i = 0; i < pairs; i++){
+        sum += sums[i];
+    }
+    return seconds;
+}
+
+int main(int argc, char* argv[]){
+    int count = argc > 1 ? atoi(argv[1]) : 1000000;
+    std::cout << "cores: " << std::thread::hardware_concurrency() << ", elements per producer: " << count << std::endl;
+    for (int pairs = 1; pairs <= 8; pairs *= 2){
+        long long lockedSum;
+        long long lockFreeSum;
+        double locked = run<LockedQueue>(pairs, count, lockedSum);
+        double lockFree = run<LockFreeQueue>(pairs, count, lockFreeSum);
+        std::cout << pairs << " pairs: mutex QueueSHPP " << locked << " s, MPMCQueueSHPP " << lockFree
+                  << " s" << (lockedSum == lockFreeSum ? "" : " (check sums differ)") << std::endl;
+    }
+    return 0;
+}